@@ -0,0 +1,351 @@
+#include "Arduino.h"
+#include "hal.h"
+#include "esp_sntp.h"
+
+#include <cctype>
+
+HardwareSerial Serial;
+
+// ============================================
+// String
+// ============================================
+String::String(const char* cstr) {
+    if (cstr) concat(cstr);
+}
+
+String::String(const String& str) {
+    concat(str.c_str(), str.len_);
+}
+
+String::String(String&& str) noexcept : buf_(str.buf_), cap_(str.cap_), len_(str.len_) {
+    str.buf_ = nullptr;
+    str.cap_ = 0;
+    str.len_ = 0;
+}
+
+String::String(char c) {
+    concat(c);
+}
+
+static void formatInteger(char* buf, size_t size, unsigned long value, bool negative, unsigned char base) {
+    char tmp[66];
+    int  i = 0;
+    do {
+        int digit = (int)(value % base);
+        tmp[i++] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        value /= base;
+    } while (value && i < (int)sizeof(tmp) - 1);
+    size_t n = 0;
+    if (negative && n < size - 1) buf[n++] = '-';
+    while (i > 0 && n < size - 1) buf[n++] = tmp[--i];
+    buf[n] = '\0';
+}
+
+String::String(unsigned char value, unsigned char base) : String((unsigned long)value, base) {}
+String::String(unsigned int value, unsigned char base) : String((unsigned long)value, base) {}
+String::String(int value, unsigned char base) : String((long)value, base) {}
+
+String::String(long value, unsigned char base) {
+    char buf[68];
+    if (base == 10 && value < 0) {
+        formatInteger(buf, sizeof(buf), 0UL - (unsigned long)value, true, base);
+    } else {
+        formatInteger(buf, sizeof(buf), (unsigned long)value, false, base);
+    }
+    concat(buf);
+}
+
+String::String(unsigned long value, unsigned char base) {
+    char buf[68];
+    formatInteger(buf, sizeof(buf), value, false, base);
+    concat(buf);
+}
+
+String::String(float value, unsigned int decimalPlaces) : String((double)value, decimalPlaces) {}
+
+String::String(double value, unsigned int decimalPlaces) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimalPlaces, value);
+    concat(buf);
+}
+
+String::~String() {
+    free(buf_);
+}
+
+String& String::operator=(const String& rhs) {
+    if (this == &rhs) return *this;
+    len_ = 0;
+    if (buf_) buf_[0] = '\0';
+    concat(rhs.c_str(), rhs.len_);
+    return *this;
+}
+
+String& String::operator=(String&& rhs) noexcept {
+    if (this == &rhs) return *this;
+    free(buf_);
+    buf_ = rhs.buf_;
+    cap_ = rhs.cap_;
+    len_ = rhs.len_;
+    rhs.buf_ = nullptr;
+    rhs.cap_ = 0;
+    rhs.len_ = 0;
+    return *this;
+}
+
+String& String::operator=(const char* cstr) {
+    len_ = 0;
+    if (buf_) buf_[0] = '\0';
+    if (cstr) concat(cstr);
+    return *this;
+}
+
+bool String::grow(unsigned int size) {
+    if (buf_ && cap_ >= size) return true;
+    char* p = (char*)realloc(buf_, size + 1);
+    if (!p) return false;
+    if (!buf_) p[0] = '\0';
+    buf_ = p;
+    cap_ = size;
+    return true;
+}
+
+unsigned char String::reserve(unsigned int size) {
+    return grow(size) ? 1 : 0;
+}
+
+unsigned char String::concat(const char* cstr, unsigned int length) {
+    if (!cstr) return 0;
+    if (!grow(len_ + length)) return 0;
+    memmove(buf_ + len_, cstr, length);
+    len_ += length;
+    buf_[len_] = '\0';
+    return 1;
+}
+
+unsigned char String::concat(const String& str) { return concat(str.c_str(), str.len_); }
+unsigned char String::concat(const char* cstr)  { return cstr ? concat(cstr, (unsigned int)strlen(cstr)) : 0; }
+unsigned char String::concat(char c)            { return concat(&c, 1); }
+unsigned char String::concat(int num)           { return concat(String(num)); }
+unsigned char String::concat(unsigned int num)  { return concat(String(num)); }
+unsigned char String::concat(long num)          { return concat(String(num)); }
+unsigned char String::concat(unsigned long num) { return concat(String(num)); }
+unsigned char String::concat(float num)         { return concat(String(num)); }
+unsigned char String::concat(double num)        { return concat(String(num)); }
+
+StringSumHelper operator+(const StringSumHelper& lhs, const String& rhs) {
+    StringSumHelper sum(lhs);
+    sum.concat(rhs);
+    return sum;
+}
+
+StringSumHelper operator+(const StringSumHelper& lhs, const char* cstr) {
+    StringSumHelper sum(lhs);
+    sum.concat(cstr);
+    return sum;
+}
+
+StringSumHelper operator+(const StringSumHelper& lhs, char c) {
+    StringSumHelper sum(lhs);
+    sum.concat(c);
+    return sum;
+}
+
+bool String::equals(const String& s) const {
+    return len_ == s.len_ && memcmp(c_str(), s.c_str(), len_) == 0;
+}
+
+bool String::equals(const char* cstr) const {
+    return strcmp(c_str(), cstr ? cstr : "") == 0;
+}
+
+bool String::startsWith(const String& prefix) const {
+    return prefix.len_ <= len_ && memcmp(c_str(), prefix.c_str(), prefix.len_) == 0;
+}
+
+bool String::endsWith(const String& suffix) const {
+    return suffix.len_ <= len_ && memcmp(c_str() + len_ - suffix.len_, suffix.c_str(), suffix.len_) == 0;
+}
+
+char String::charAt(unsigned int index) const {
+    return index < len_ ? buf_[index] : '\0';
+}
+
+int String::indexOf(char ch, unsigned int fromIndex) const {
+    if (fromIndex >= len_) return -1;
+    const char* p = (const char*)memchr(buf_ + fromIndex, ch, len_ - fromIndex);
+    return p ? (int)(p - buf_) : -1;
+}
+
+int String::indexOf(const String& str, unsigned int fromIndex) const {
+    if (fromIndex >= len_) return -1;
+    const char* p = strstr(buf_ + fromIndex, str.c_str());
+    return p ? (int)(p - buf_) : -1;
+}
+
+String String::substring(unsigned int beginIndex, unsigned int endIndex) const {
+    if (beginIndex > endIndex) {
+        unsigned int t = beginIndex;
+        beginIndex = endIndex;
+        endIndex = t;
+    }
+    String out;
+    if (beginIndex >= len_) return out;
+    if (endIndex > len_) endIndex = len_;
+    out.concat(buf_ + beginIndex, endIndex - beginIndex);
+    return out;
+}
+
+void String::trim() {
+    if (!len_) return;
+    unsigned int begin = 0;
+    unsigned int end = len_;
+    while (begin < end && isspace((unsigned char)buf_[begin])) begin++;
+    while (end > begin && isspace((unsigned char)buf_[end - 1])) end--;
+    len_ = end - begin;
+    memmove(buf_, buf_ + begin, len_);
+    buf_[len_] = '\0';
+}
+
+long String::toInt() const {
+    return buf_ ? atol(buf_) : 0;
+}
+
+float String::toFloat() const {
+    return buf_ ? (float)atof(buf_) : 0.0f;
+}
+
+// ============================================
+// Serial - output is paced at the configured baud rate
+// ============================================
+void HardwareSerial::begin(unsigned long baud) {
+    hal::device().serialBaud = (uint32_t)baud;
+    hal::spendUs(100, hal::Cpu::Active);
+}
+
+void HardwareSerial::end() {
+    hal::device().serialBaud = 0;
+}
+
+void HardwareSerial::flush() {}
+
+int HardwareSerial::available() {
+    return (int)hal::device().serialInput.size();
+}
+
+int HardwareSerial::read() {
+    std::string& input = hal::device().serialInput;
+    if (input.empty()) return -1;
+    int c = (unsigned char)input[0];
+    input.erase(0, 1);
+    return c;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    hal::serialWrite((const char*)buffer, size);
+    return size;
+}
+
+size_t HardwareSerial::write(uint8_t c) { return write(&c, 1); }
+size_t HardwareSerial::print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+size_t HardwareSerial::print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+size_t HardwareSerial::print(char c) { return write((uint8_t)c); }
+size_t HardwareSerial::print(int n) { return print(String(n)); }
+size_t HardwareSerial::print(unsigned int n) { return print(String(n)); }
+size_t HardwareSerial::print(long n) { return print(String(n)); }
+size_t HardwareSerial::print(unsigned long n) { return print(String(n)); }
+size_t HardwareSerial::print(double n, int digits) { return print(String(n, (unsigned int)digits)); }
+size_t HardwareSerial::println() { return print("\r\n"); }
+
+size_t HardwareSerial::printf(const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (n < 0) return 0;
+    return write((const uint8_t*)buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+}
+
+// ============================================
+// Core functions
+// ============================================
+unsigned long millis() {
+    return (unsigned long)(hal::sinceBootUs() / 1000ULL);
+}
+
+unsigned long micros() {
+    return (unsigned long)hal::sinceBootUs();
+}
+
+void delay(uint32_t ms) {
+    hal::spendMs(ms, hal::Cpu::Idle);
+}
+
+void delayMicroseconds(uint32_t us) {
+    hal::spendUs(us, hal::Cpu::Active);
+}
+
+void yield() {
+    hal::spendUs(10, hal::Cpu::Active);
+}
+
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int  digitalRead(uint8_t) { return LOW; }
+
+// Same polling loop as esp32-hal-time.c
+bool getLocalTime(struct tm* info, uint32_t ms) {
+    uint32_t start = millis();
+    time_t now;
+    while ((millis() - start) <= ms) {
+        if (hal::wallClock(&now)) {
+            gmtime_r(&now, info);
+            if (info->tm_year > (2016 - 1900)) return true;
+        }
+        delay(10);
+    }
+    return false;
+}
+
+static sntp_sync_time_cb_t s_timeSyncCallback = nullptr;
+
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback) {
+    s_timeSyncCallback = callback;
+}
+
+void configTime(long, int, const char*, const char*, const char*) {
+    hal::Device& dev = hal::device();
+    if (dev.wifiConnected && hal::env().ntp.reachable) {
+        dev.ntpPending = true;
+        dev.ntpDueUs = dev.clockUs + (uint64_t)hal::env().ntp.syncMs * 1000ULL;
+        hal::post(dev.ntpDueUs, []() {
+            time_t now;
+            if (!hal::wallClock(&now) || !s_timeSyncCallback) return;
+            struct timeval tv = { now, 0 };
+            s_timeSyncCallback(&tv);
+        });
+    }
+}
+
+esp_reset_reason_t esp_reset_reason() {
+    return hal::device().coldBoot ? ESP_RST_POWERON : ESP_RST_DEEPSLEEP;
+}
+
+// ============================================
+// ESP - heap figures typical of this firmware on a WROOM with WiFi and
+// one TLS session up; the host heap says nothing about the target's
+// ============================================
+EspClass ESP;
+
+uint32_t EspClass::getFreeHeap()    { return 236000; }
+uint32_t EspClass::getMinFreeHeap() { return 198000; }
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us) {
+    hal::device().sleepUs = time_in_us;
+    return ESP_OK;
+}
+
+void esp_deep_sleep_start() {
+    throw hal::DeepSleep();
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+// ============================================
+// Host fake of the Arduino-ESP32 core
+// Only the surface the firmware uses. Time and power come from hal.h.
+// ============================================
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <math.h>
+#include <time.h>
+
+// RTC slow memory: collected in one section so the simulator can save,
+// restore and reset it per device across deep sleep and power cycles
+#define RTC_DATA_ATTR __attribute__((section("rtc_data")))
+
+#define HIGH    1
+#define LOW     0
+#define INPUT   0x01
+#define OUTPUT  0x03
+
+typedef uint8_t byte;
+typedef bool    boolean;
+typedef int     esp_err_t;
+#define ESP_OK  0
+
+// ============================================
+// String - malloc-backed like the real one
+// ============================================
+class StringSumHelper;
+
+class String {
+public:
+    String(const char* cstr = "");
+    String(const String& str);
+    String(String&& str) noexcept;
+    explicit String(char c);
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(float value, unsigned int decimalPlaces = 2);
+    explicit String(double value, unsigned int decimalPlaces = 2);
+    ~String();
+
+    String& operator=(const String& rhs);
+    String& operator=(String&& rhs) noexcept;
+    String& operator=(const char* cstr);
+
+    unsigned char reserve(unsigned int size);
+    unsigned int  length() const { return len_; }
+    const char*   c_str() const { return buf_ ? buf_ : ""; }
+    bool          isEmpty() const { return len_ == 0; }
+
+    unsigned char concat(const String& str);
+    unsigned char concat(const char* cstr);
+    unsigned char concat(const char* cstr, unsigned int length);
+    unsigned char concat(char c);
+    unsigned char concat(int num);
+    unsigned char concat(unsigned int num);
+    unsigned char concat(long num);
+    unsigned char concat(unsigned long num);
+    unsigned char concat(float num);
+    unsigned char concat(double num);
+
+    String& operator+=(const String& rhs) { concat(rhs); return *this; }
+    String& operator+=(const char* cstr)  { concat(cstr); return *this; }
+    String& operator+=(char c)            { concat(c); return *this; }
+    String& operator+=(int num)           { concat(num); return *this; }
+    String& operator+=(unsigned int num)  { concat(num); return *this; }
+    String& operator+=(long num)          { concat(num); return *this; }
+    String& operator+=(unsigned long num) { concat(num); return *this; }
+
+    friend StringSumHelper operator+(const StringSumHelper& lhs, const String& rhs);
+    friend StringSumHelper operator+(const StringSumHelper& lhs, const char* cstr);
+    friend StringSumHelper operator+(const StringSumHelper& lhs, char c);
+
+    bool equals(const String& s) const;
+    bool equals(const char* cstr) const;
+    bool operator==(const String& rhs) const { return equals(rhs); }
+    bool operator==(const char* cstr) const { return equals(cstr); }
+    bool operator!=(const String& rhs) const { return !equals(rhs); }
+    bool operator!=(const char* cstr) const { return !equals(cstr); }
+    bool startsWith(const String& prefix) const;
+    bool endsWith(const String& suffix) const;
+
+    char  charAt(unsigned int index) const;
+    char  operator[](unsigned int index) const { return charAt(index); }
+    int   indexOf(char ch, unsigned int fromIndex = 0) const;
+    int   indexOf(const String& str, unsigned int fromIndex = 0) const;
+    String substring(unsigned int beginIndex) const { return substring(beginIndex, len_); }
+    String substring(unsigned int beginIndex, unsigned int endIndex) const;
+    void  trim();
+    long  toInt() const;
+    float toFloat() const;
+
+private:
+    bool grow(unsigned int size);
+
+    char*        buf_ = nullptr;
+    unsigned int cap_ = 0;
+    unsigned int len_ = 0;
+};
+
+class StringSumHelper : public String {
+public:
+    StringSumHelper(const String& s) : String(s) {}
+    StringSumHelper(const char* p) : String(p) {}
+    StringSumHelper(char c) : String(c) {}
+    StringSumHelper(int num) : String(num) {}
+    StringSumHelper(unsigned long num) : String(num) {}
+    StringSumHelper(float num) : String(num) {}
+    StringSumHelper(double num) : String(num) {}
+};
+
+// ============================================
+// Serial
+// ============================================
+class HardwareSerial {
+public:
+    void   begin(unsigned long baud);
+    void   end();
+    void   flush();
+    int    available();
+    int    read();
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buffer, size_t size);
+    size_t print(const String& s);
+    size_t print(const char* s);
+    size_t print(char c);
+    size_t print(int n);
+    size_t print(unsigned int n);
+    size_t print(long n);
+    size_t print(unsigned long n);
+    size_t print(double n, int digits = 2);
+    size_t println();
+    template <typename T> size_t println(const T& v) { size_t n = print(v); return n + println(); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+    explicit operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+// ============================================
+// Core functions
+// ============================================
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int  digitalRead(uint8_t pin);
+
+// esp32-hal-time
+bool getLocalTime(struct tm* info, uint32_t ms = 5000);
+void configTime(long gmtOffset_sec, int daylightOffset_sec,
+                const char* server1, const char* server2 = nullptr, const char* server3 = nullptr);
+
+// esp_system.h
+typedef enum {
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+esp_reset_reason_t esp_reset_reason();
+
+// Esp.h
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+};
+
+extern EspClass ESP;
+
+// esp_sleep.h
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us);
+[[noreturn]] void esp_deep_sleep_start();
@@ -0,0 +1,119 @@
+#include "DallasTemperature.h"
+#include "hal.h"
+
+// The library counts 1/128 degC in raw readings
+static int32_t toRaw(float c) { return (int32_t)lroundf(c * 128.0f); }
+
+// Bus reset + ROM search
+void DallasTemperature::begin() {
+    hal::spendMs(12, hal::Cpu::Active);
+    found_ = hal::env().sensor.present;
+}
+
+uint8_t DallasTemperature::getDeviceCount() {
+    return found_ ? 1 : 0;
+}
+
+// Another ROM search, to the index-th device
+bool DallasTemperature::getAddress(uint8_t* deviceAddress, uint8_t index) {
+    hal::spendMs(2, hal::Cpu::Active);
+    if (index != 0 || !found_) return false;
+    static const uint8_t rom[8] = { 0x28, 0xFF, 0x64, 0x1E, 0x0C, 0x00, 0x00, 0x5A };
+    memcpy(deviceAddress, rom, sizeof(rom));
+    return true;
+}
+
+// Write the configuration register (scratchpad, not EEPROM)
+bool DallasTemperature::setResolution(const uint8_t* deviceAddress, uint8_t newResolution) {
+    (void)deviceAddress;
+    hal::spendMs(3, hal::Cpu::Active);
+    if (!found_ || newResolution < 9 || newResolution > 12) return false;
+    bits_ = newResolution;
+    return true;
+}
+
+int16_t DallasTemperature::millisToWaitForConversion(uint8_t bitResolution) {
+    switch (bitResolution) {
+        case 9:  return 94;
+        case 10: return 188;
+        case 11: return 375;
+        default: return 750;
+    }
+}
+
+// With setWaitForConversion(true), the default, the library polls the bus
+// for conversion-done with yield(), so the CPU stays busy for the whole
+// conversion. With false it sends Convert T and returns; the result shows
+// up in the scratchpad once the silicon is done, in virtual time.
+void DallasTemperature::requestTemperatures() {
+    const hal::SensorModel& sensor = hal::env().sensor;
+    if (!found_ || !sensor.present) {
+        hal::spendMs(2, hal::Cpu::Active);
+        lastRaw_ = DEVICE_DISCONNECTED_RAW;
+        readyUs_ = 0;
+        return;
+    }
+    convert();
+    // 750 ms at 12 bits, 94 ms at 9
+    uint32_t conversionMs = sensor.conversionMs >> (12 - bits_);
+    if (wait_) {
+        hal::spendMs(conversionMs, hal::Cpu::Active);
+        lastRaw_ = pendingRaw_;
+        readyUs_ = 0;
+    } else {
+        hal::spendMs(2, hal::Cpu::Active);
+        readyUs_ = hal::device().clockUs + (uint64_t)conversionMs * 1000ULL;
+    }
+}
+
+// One read slot: the sensor holds the line low while converting; an
+// empty bus reads high
+bool DallasTemperature::isConversionComplete() {
+    hal::spendUs(70, hal::Cpu::Active);
+    return !readyUs_ || hal::device().clockUs >= readyUs_;
+}
+
+// The value the conversion just started will leave in the scratchpad
+void DallasTemperature::convert() {
+    hal::Device& dev = hal::device();
+    float c;
+    bool glitched;
+    if (!hal::convertSensor(c, glitched)) {
+        pendingRaw_ = DEVICE_DISCONNECTED_RAW;
+        return;
+    }
+    if (glitched) {
+        pendingRaw_ = toRaw(c);
+        return;
+    }
+    if (dev.sensorFresh) {
+        // Power-on reset value of the scratchpad
+        dev.sensorFresh = false;
+        pendingRaw_ = toRaw(85.0f);
+        return;
+    }
+    // 1/16 degC steps at 12 bits, 1/2 at 9
+    int32_t step = 8 << (12 - bits_);
+    pendingRaw_ = (int32_t)lroundf(c * 128.0f / step) * step;
+}
+
+// Select by ROM + read scratchpad
+int32_t DallasTemperature::getTemp(const uint8_t* deviceAddress) {
+    (void)deviceAddress;
+    hal::spendMs(3, hal::Cpu::Active);
+    if (!hal::env().sensor.present) return DEVICE_DISCONNECTED_RAW;
+    if (readyUs_ && hal::device().clockUs >= readyUs_) {
+        lastRaw_ = pendingRaw_;
+        readyUs_ = 0;
+    }
+    // Read mid-conversion: still the previous result
+    return lastRaw_;
+}
+
+// ROM search to the index-th device + scratchpad read
+float DallasTemperature::getTempCByIndex(uint8_t index) {
+    hal::spendMs(2, hal::Cpu::Active);
+    if (index != 0 || !hal::env().sensor.present) return DEVICE_DISCONNECTED_C;
+    int32_t raw = getTemp(nullptr);
+    return raw == DEVICE_DISCONNECTED_RAW ? DEVICE_DISCONNECTED_C : raw / 128.0f;
+}
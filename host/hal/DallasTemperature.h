@@ -0,0 +1,39 @@
+#pragma once
+
+// Host fake of DallasTemperature for one DS18B20 per bus, driven by the
+// scenario. Every bus sees the same sensor model.
+#include "OneWire.h"
+
+#define DEVICE_DISCONNECTED_C   -127
+#define DEVICE_DISCONNECTED_RAW -7040
+
+typedef uint8_t DeviceAddress[8];
+
+class DallasTemperature {
+public:
+    DallasTemperature() {}
+    explicit DallasTemperature(OneWire* wire) : wire_(wire) {}
+
+    void    setOneWire(OneWire* wire) { wire_ = wire; }
+    void    begin();
+    uint8_t getDeviceCount();
+    bool    getAddress(uint8_t* deviceAddress, uint8_t index);
+    bool    setResolution(const uint8_t* deviceAddress, uint8_t newResolution);
+    void    setWaitForConversion(bool wait) { wait_ = wait; }
+    int16_t millisToWaitForConversion(uint8_t bitResolution);
+    void    requestTemperatures();
+    bool    isConversionComplete();
+    int32_t getTemp(const uint8_t* deviceAddress);   // 1/128 degC
+    float   getTempCByIndex(uint8_t index);
+
+private:
+    void    convert();
+
+    OneWire* wire_ = nullptr;
+    bool     found_ = false;
+    bool     wait_  = true;
+    uint8_t  bits_  = 12;           // power-on default
+    uint64_t readyUs_ = 0;          // device clock when the conversion in flight ends
+    int32_t  pendingRaw_ = DEVICE_DISCONNECTED_RAW;
+    int32_t  lastRaw_ = DEVICE_DISCONNECTED_RAW;
+};
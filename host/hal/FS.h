@@ -0,0 +1,77 @@
+#pragma once
+
+// Host fake of the Arduino-ESP32 FS/File API backed by hal::Device::files
+#include <memory>
+#include <string>
+
+#include "Arduino.h"
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File {
+public:
+    File() = default;
+    File(const std::string& path, const char* mode);
+
+    explicit operator bool() const { return (bool)state_; }
+
+    size_t write(uint8_t c);
+    size_t write(const uint8_t* buf, size_t size);
+    size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t println() { return print("\r\n"); }
+    size_t println(const String& s) { return print(s) + println(); }
+    size_t println(const char* s) { return print(s) + println(); }
+
+    int    available();
+    int    read();
+    size_t read(uint8_t* buf, size_t size);
+    int    peek();
+    String readStringUntil(char terminator);
+    bool   seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void   flush() {}
+    void   close();
+    const char* name() const;
+
+private:
+    struct State {
+        std::string path;
+        size_t      pos       = 0;
+        size_t      startSize = 0;
+        bool        append    = false;
+        bool        written   = false;
+    };
+    std::string& data() const;
+
+    std::shared_ptr<State> state_;
+};
+
+class FS {
+public:
+    File open(const char* path, const char* mode = FILE_READ, const bool create = false);
+    File open(const String& path, const char* mode = FILE_READ, const bool create = false) {
+        return open(path.c_str(), mode, create);
+    }
+    bool exists(const char* path);
+    bool exists(const String& path) { return exists(path.c_str()); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+    bool rename(const char* pathFrom, const char* pathTo);
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
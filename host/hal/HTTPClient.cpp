@@ -0,0 +1,69 @@
+#include "HTTPClient.h"
+#include "hal.h"
+
+bool HTTPClient::begin(String url) {
+    url_ = url.c_str();
+    return true;
+}
+
+bool HTTPClient::begin(WiFiClient& client, String url) {
+    client_ = &client;
+    return begin(url);
+}
+
+void HTTPClient::end() {
+    if (client_ && !reuse_) client_->stop();
+}
+
+void HTTPClient::addHeader(const String&, const String&, bool, bool) {}
+
+int HTTPClient::POST(const String& payload) {
+    return POST((uint8_t*)payload.c_str(), payload.length());
+}
+
+// DNS -> TCP/TLS handshake -> send -> wait for the response; the first
+// two are skipped over a client that is already connected
+int HTTPClient::POST(uint8_t* payload, size_t size) {
+    hal::Device& dev = hal::device();
+    const hal::ServerModel& server = hal::env().server;
+
+    hal::HttpExchange exchange;
+    exchange.startUs = dev.clockUs;
+    exchange.url     = url_;
+    exchange.payload.assign((const char*)payload, size);
+
+    int status;
+    if (!dev.wifiConnected) {
+        status = HTTPC_ERROR_CONNECTION_REFUSED;
+    } else {
+        bool open = client_ && client_->connected();
+        if (!open) hal::spendMs(server.dnsMs, hal::Cpu::Idle, hal::Radio::Rx);
+        if (!server.up) {
+            hal::spendMs(connectTimeoutMs_, hal::Cpu::Idle, hal::Radio::Idle);
+            status = HTTPC_ERROR_CONNECTION_REFUSED;
+        } else {
+            if (!open) hal::spendMs(server.tlsMs, hal::Cpu::Active, hal::Radio::Rx);
+            // ~1 Mbit/s of useful throughput after protocol overhead, at least one frame
+            uint64_t txUs = 2000 + (uint64_t)size * 8ULL;
+            hal::spendUs(txUs, hal::Cpu::Active, hal::Radio::Tx);
+            uint32_t latencyMs = server.latencyMs;
+            status = server.status;
+            if (hal::env().infrastructure) {
+                hal::env().infrastructure->serve(dev.clockUs, size, status, latencyMs);
+            }
+            if (latencyMs > timeoutMs_) {
+                hal::spendMs(timeoutMs_, hal::Cpu::Idle, hal::Radio::Idle);
+                status = HTTPC_ERROR_READ_TIMEOUT;
+            } else {
+                hal::spendMs(latencyMs, hal::Cpu::Idle, hal::Radio::Idle);
+            }
+        }
+    }
+
+    exchange.endUs  = dev.clockUs;
+    exchange.status = status;
+    if (status == 200) dev.httpOk++;
+    else dev.httpFailed++;
+    if (dev.recordHttp) dev.http.push_back(exchange);
+    return status;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+// Host fake of HTTPClient: costs come from the scenario's server model
+#include <string>
+
+#include "WiFi.h"
+#include "WiFiClientSecure.h"
+
+#define HTTPC_ERROR_CONNECTION_REFUSED  (-1)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED       (-4)
+#define HTTPC_ERROR_CONNECTION_LOST     (-5)
+#define HTTPC_ERROR_READ_TIMEOUT        (-11)
+
+#define HTTPCLIENT_DEFAULT_TCP_TIMEOUT  (5000)
+
+class HTTPClient {
+public:
+    bool   begin(String url);
+    bool   begin(WiFiClient& client, String url);   // over the client's session, if it has one
+    void   setReuse(bool reuse) { reuse_ = reuse; }
+    void   end();
+    void   addHeader(const String& name, const String& value, bool first = false, bool replace = true);
+    void   setTimeout(uint16_t timeout) { timeoutMs_ = timeout; }
+    void   setConnectTimeout(int32_t connectTimeout) { connectTimeoutMs_ = (uint32_t)connectTimeout; }
+    int    POST(uint8_t* payload, size_t size);
+    int    POST(const String& payload);
+    String getString() { return String(); }
+
+private:
+    std::string url_;
+    WiFiClient* client_           = nullptr;
+    bool        reuse_            = true;
+    uint32_t    timeoutMs_        = HTTPCLIENT_DEFAULT_TCP_TIMEOUT;
+    uint32_t    connectTimeoutMs_ = HTTPCLIENT_DEFAULT_TCP_TIMEOUT;
+};
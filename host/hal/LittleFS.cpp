@@ -0,0 +1,254 @@
+#include "LittleFS.h"
+
+#include <sys/types.h>
+#include <cerrno>
+#include <cstring>
+
+#include "esp_partition.h"
+#include "hal.h"
+
+fs::LittleFSFS LittleFS;
+
+namespace fs {
+
+// Default ESP32 "spiffs" partition in the 4 MB layout
+static const size_t PARTITION_BYTES = 0x160000;
+
+// ============================================
+// On-flash behaviour of littlefs with the esp_littlefs defaults
+// Closing a file after writes programs what littlefs would: small files
+// ride inline in the metadata commit; larger ones copy their partly filled
+// last block into a freshly erased one (lfs_ctz_extend) before appending.
+// Metadata blocks compact, with an erase, when full.
+// ============================================
+static const size_t BLOCK_SIZE    = 4096;
+static const size_t PROG_SIZE     = 128;
+static const size_t INLINE_MAX    = 512;
+static const size_t COMMIT_BYTES  = 128;   // tags, CRC, CTZ pointer, padding
+static const size_t COMPACT_BYTES = 512;   // live metadata after compaction
+
+static const esp_partition_t s_partition = {
+    ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, 0x290000, (uint32_t)PARTITION_BYTES, "spiffs", false
+};
+
+static size_t roundToProg(size_t bytes) {
+    return (bytes + PROG_SIZE - 1) / PROG_SIZE * PROG_SIZE;
+}
+
+static void program(size_t bytes) {
+    static const uint8_t blank[BLOCK_SIZE] = {};
+    while (bytes > 0) {
+        size_t chunk = bytes < BLOCK_SIZE ? bytes : BLOCK_SIZE;
+        esp_partition_write(&s_partition, 0, blank, chunk);
+        bytes -= chunk;
+    }
+}
+
+static void commitMetadata(size_t inlineBytes) {
+    hal::Device& dev = hal::device();
+    size_t commit = roundToProg(COMMIT_BYTES + inlineBytes);
+    if (dev.mdirFill + commit > BLOCK_SIZE) {
+        esp_partition_erase_range(&s_partition, 0, BLOCK_SIZE);
+        program(COMPACT_BYTES);
+        dev.mdirFill = COMPACT_BYTES;
+    }
+    program(commit);
+    dev.mdirFill += (uint32_t)commit;
+}
+
+static void commitFile(size_t before, size_t after) {
+    size_t inlineBytes = 0;
+    if (after > INLINE_MAX) {
+        size_t carried = before <= INLINE_MAX ? before : before % BLOCK_SIZE;
+        size_t bytes = carried + (after > before ? after - before : 0);
+        size_t blocks = (bytes + BLOCK_SIZE - 1) / BLOCK_SIZE;
+        esp_partition_erase_range(&s_partition, 0, blocks * BLOCK_SIZE);
+        program(roundToProg(bytes));
+    } else {
+        inlineBytes = after;
+    }
+    commitMetadata(inlineBytes);
+}
+
+// ============================================
+// File
+// ============================================
+File::File(const std::string& path, const char* mode) : state_(new State) {
+    state_->path = path;
+    std::string& content = data();
+    if (mode[0] == 'w') content.clear();
+    state_->startSize = content.size();
+    state_->append = mode[0] == 'a';
+    state_->pos = state_->append ? content.size() : 0;
+}
+
+std::string& File::data() const {
+    return hal::device().files[state_->path];
+}
+
+size_t File::write(const uint8_t* buf, size_t size) {
+    if (!state_) return 0;
+    hal::Device& dev = hal::device();
+    bool cut = dev.powerCutAfterBytes >= 0 && (int64_t)size > dev.powerCutAfterBytes;
+    if (cut) {
+        size = (size_t)dev.powerCutAfterBytes;
+        dev.powerCutAfterBytes = -1;
+    }
+    else if (dev.powerCutAfterBytes >= 0) dev.powerCutAfterBytes -= (int64_t)size;
+
+    std::string& content = data();
+    if (state_->append) state_->pos = content.size();
+    if (state_->pos > content.size()) state_->pos = content.size();
+    content.replace(state_->pos, size < content.size() - state_->pos ? size : content.size() - state_->pos,
+                    (const char*)buf, size);
+    state_->pos += size;
+    state_->written = true;
+    dev.fsBytesWritten += size;
+    if (cut) throw hal::PowerCut();
+    return size;
+}
+
+size_t File::write(uint8_t c) { return write(&c, 1); }
+
+int File::available() {
+    if (!state_) return 0;
+    size_t n = data().size();
+    return state_->pos < n ? (int)(n - state_->pos) : 0;
+}
+
+int File::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+    if (!state_) return 0;
+    const std::string& content = data();
+    if (state_->pos >= content.size()) return 0;
+    size_t n = content.size() - state_->pos;
+    if (n > size) n = size;
+    memcpy(buf, content.data() + state_->pos, n);
+    state_->pos += n;
+    hal::device().fsBytesRead += n;
+    return n;
+}
+
+int File::peek() {
+    if (!available()) return -1;
+    return (uint8_t)data()[state_->pos];
+}
+
+String File::readStringUntil(char terminator) {
+    String out;
+    int c;
+    while ((c = read()) >= 0 && c != terminator) out += (char)c;
+    return out;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    if (!state_) return false;
+    size_t base = mode == SeekSet ? 0 : mode == SeekCur ? state_->pos : data().size();
+    state_->pos = base + pos;
+    return state_->pos <= data().size();
+}
+
+size_t File::position() const { return state_ ? state_->pos : 0; }
+size_t File::size() const { return state_ ? data().size() : 0; }
+const char* File::name() const { return state_ ? state_->path.c_str() : ""; }
+
+void File::close() {
+    if (!state_) return;
+    if (state_->written) {
+        hal::spendMs(hal::env().fs.commitMs, hal::Cpu::Active);
+        commitFile(state_->startSize, data().size());
+        hal::device().fsWriteOps++;
+    }
+    state_.reset();
+}
+
+// ============================================
+// FS
+// ============================================
+File FS::open(const char* path, const char* mode, const bool) {
+    hal::Device& dev = hal::device();
+    if (!dev.fsMounted) return File();
+    hal::spendMs(hal::env().fs.openMs, hal::Cpu::Active);
+    if (hal::env().fs.openFails) return File();
+    if (mode[0] == 'r' && !dev.files.count(path)) return File();
+    return File(path, mode);
+}
+
+bool FS::exists(const char* path) {
+    hal::Device& dev = hal::device();
+    return dev.fsMounted && dev.files.count(path) > 0;
+}
+
+bool FS::remove(const char* path) {
+    hal::Device& dev = hal::device();
+    return dev.fsMounted && dev.files.erase(path) > 0;
+}
+
+bool FS::rename(const char* pathFrom, const char* pathTo) {
+    hal::Device& dev = hal::device();
+    auto it = dev.files.find(pathFrom);
+    if (!dev.fsMounted || it == dev.files.end()) return false;
+    dev.files[pathTo] = it->second;
+    dev.files.erase(pathFrom);
+    return true;
+}
+
+// ============================================
+// LittleFSFS
+// ============================================
+bool LittleFSFS::begin(bool, const char*, uint8_t, const char*) {
+    hal::spendMs(hal::env().fs.mountMs, hal::Cpu::Active);
+    hal::device().fsMounted = !hal::env().fs.mountFails;
+    return hal::device().fsMounted;
+}
+
+void LittleFSFS::end() {
+    hal::device().fsMounted = false;
+}
+
+bool LittleFSFS::format() {
+    hal::device().files.clear();
+    return true;
+}
+
+size_t LittleFSFS::totalBytes() {
+    return PARTITION_BYTES;
+}
+
+size_t LittleFSFS::usedBytes() {
+    size_t used = 0;
+    for (const auto& file : hal::device().files) used += file.second.size();
+    return used;
+}
+
+} // namespace fs
+
+// ============================================
+// truncate() through the VFS
+// The Arduino FS API has none, so the firmware calls POSIX truncate() on
+// the mount path. The native build wraps it (-Wl,--wrap=truncate) and
+// paths under the mount land here; littlefs shrinks a file with one
+// metadata commit.
+// ============================================
+extern "C" int __real_truncate(const char* path, off_t length);
+
+extern "C" int __wrap_truncate(const char* path, off_t length) {
+    static const char BASE[] = "/littlefs/";
+    if (strncmp(path, BASE, sizeof(BASE) - 2) != 0) return __real_truncate(path, length);
+
+    hal::Device& dev = hal::device();
+    auto it = dev.files.find(path + sizeof(BASE) - 2);
+    if (!dev.fsMounted || it == dev.files.end()) {
+        errno = ENOENT;
+        return -1;
+    }
+    it->second.resize((size_t)length);
+    hal::spendMs(hal::env().fs.commitMs, hal::Cpu::Active);
+    fs::commitMetadata(it->second.size() <= fs::INLINE_MAX ? it->second.size() : 0);
+    dev.fsWriteOps++;
+    return 0;
+}
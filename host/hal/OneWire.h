@@ -0,0 +1,15 @@
+#pragma once
+
+// Host fake of the OneWire bus - the sensor model lives in DallasTemperature
+#include "Arduino.h"
+
+class OneWire {
+public:
+    OneWire() {}
+    explicit OneWire(uint8_t pin) : pin_(pin) {}
+    void    begin(uint8_t pin) { pin_ = pin; }
+    uint8_t pin() const { return pin_; }
+
+private:
+    uint8_t pin_ = 0;
+};
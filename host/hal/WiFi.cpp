@@ -0,0 +1,233 @@
+#include "WiFi.h"
+#include "hal.h"
+
+WiFiClass WiFi;
+
+String IPAddress::toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", octets_[0], octets_[1], octets_[2], octets_[3]);
+    return String(buf);
+}
+
+// ============================================
+// WiFiClass
+// ============================================
+// Strongest in-range AP named ssid, or nullptr
+static const hal::AccessPoint* findAp(const std::string& ssid) {
+    const hal::AccessPoint* found = nullptr;
+    for (const hal::AccessPoint& ap : hal::env().wifi.aps) {
+        if (ap.inRange && ap.ssid == ssid && (!found || ap.rssi > found->rssi)) found = &ap;
+    }
+    return found;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char*, int32_t channel, const uint8_t*, bool) {
+    hal::Device& dev = hal::device();
+    if (dev.wifiConnected) return status_ = WL_CONNECTED;
+
+    mode(WIFI_STA);
+    uint32_t attempt = ++attempt_;
+    status_ = WL_DISCONNECTED;
+    dev.radio = hal::Radio::Rx;
+
+    const hal::WifiModel& model = hal::env().wifi;
+    uint64_t scannedUs = dev.clockUs + (uint64_t)(channel ? model.probeMs : model.scanMs) * 1000ULL;
+    std::string name = ssid;
+    hal::post(scannedUs, [this, attempt, name, channel]() {
+        if (attempt != attempt_) return;
+        const hal::AccessPoint* ap = findAp(name);
+        if (!ap || !hal::env().wifi.apUp || (channel && ap->channel != channel)) {
+            fail(WL_NO_SSID_AVAIL, WIFI_REASON_NO_AP_FOUND);
+        } else {
+            associate(*ap, attempt);
+        }
+    });
+    return status_;
+}
+
+// Auth, association and DHCP, from the end of the scan
+void WiFiClass::associate(const hal::AccessPoint& ap, uint32_t attempt) {
+    hal::Device& dev = hal::device();
+    const hal::WifiModel& model = hal::env().wifi;
+    uint32_t connectMs = model.connectMs;
+    bool admitted = !hal::env().infrastructure || hal::env().infrastructure->associate(dev.clockUs, connectMs);
+    uint64_t doneUs = dev.clockUs + (uint64_t)connectMs * 1000ULL;
+    if (!admitted) {
+        hal::post(doneUs, [this, attempt]() {
+            if (attempt == attempt_) fail(WL_CONNECT_FAILED, WIFI_REASON_ASSOC_FAIL);
+        });
+        return;
+    }
+
+    uint32_t txMs = model.connectTxMs < connectMs ? model.connectTxMs : connectMs;
+    dev.radio = hal::Radio::Tx;
+    hal::post(dev.clockUs + (uint64_t)txMs * 1000ULL, [this, attempt]() {
+        if (attempt == attempt_) hal::device().radio = hal::Radio::Rx;
+    });
+
+    hal::AccessPoint joined = ap;
+    hal::post(doneUs, [this, attempt, joined]() {
+        if (attempt != attempt_) return;
+        hal::Device& dev = hal::device();
+        const hal::WifiModel& model = hal::env().wifi;
+        // The AP hears us as we hear it, less what we transmit below its power,
+        // taken as the same 19.5 dBm; too weak and the handshake times out
+        int rssi = joined.rssi - model.fadeDb;
+        if (rssi - (78 - dev.txPowerQdBm) / 4 < model.apSensitivityDbm) {
+            if (hal::env().infrastructure) hal::env().infrastructure->disassociate(dev.clockUs);
+            fail(WL_CONNECT_FAILED, WIFI_REASON_HANDSHAKE_TIMEOUT);
+            return;
+        }
+        dev.wifiConnected = true;
+        dev.ssid = joined.ssid;
+        dev.rssi = rssi;
+        dev.channel = joined.channel;
+        dev.radio = hal::Radio::Idle;
+        status_ = WL_CONNECTED;
+        raise(ARDUINO_EVENT_WIFI_STA_CONNECTED);
+        raise(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+    });
+}
+
+void WiFiClass::fail(wl_status_t status, uint8_t reason) {
+    hal::device().radio = hal::Radio::Idle;
+    status_ = status;
+    raise(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, reason);
+}
+
+void WiFiClass::raise(arduino_event_id_t event, uint8_t reason) {
+    // Copied: a handler may register another
+    auto handlers = hal::device().wifiEventHandlers;
+    for (const auto& handler : handlers) handler(event, reason);
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb cbEvent, arduino_event_id_t event) {
+    auto& handlers = hal::device().wifiEventHandlers;
+    handlers.push_back([cbEvent, event](int id, uint8_t reason) {
+        if (event != ARDUINO_EVENT_MAX && event != id) return;
+        arduino_event_info_t info = {};
+        info.wifi_sta_disconnected.reason = reason;
+        cbEvent((arduino_event_id_t)id, info);
+    });
+    return (wifi_event_id_t)handlers.size();
+}
+
+wl_status_t WiFiClass::status() {
+    if (hal::device().wifiConnected) return WL_CONNECTED;
+    return status_ == WL_CONNECTED ? WL_DISCONNECTED : status_;
+}
+
+String WiFiClass::SSID() const {
+    return String(hal::device().ssid.c_str());
+}
+
+int8_t WiFiClass::RSSI() {
+    return (int8_t)hal::device().rssi;
+}
+
+int32_t WiFiClass::channel() {
+    return hal::device().channel;
+}
+
+IPAddress WiFiClass::localIP() {
+    return hal::device().wifiConnected ? IPAddress(192, 168, 1, 101) : IPAddress();
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+    hal::Device& dev = hal::device();
+    if (mode == WIFI_MODE_NULL) {
+        disconnect();
+        dev.radio = hal::Radio::Off;
+    } else if (dev.radio == hal::Radio::Off) {
+        // PHY calibration when the radio starts
+        hal::spendMs(30, hal::Cpu::Active, hal::Radio::Rx);
+        dev.radio = hal::Radio::Idle;
+    }
+    return true;
+}
+
+bool WiFiClass::disconnect(bool wifioff, bool) {
+    hal::Device& dev = hal::device();
+    bool active = dev.wifiConnected || status_ == WL_DISCONNECTED;
+    attempt_++;
+    if (dev.wifiConnected && hal::env().infrastructure) {
+        hal::env().infrastructure->disassociate(dev.clockUs);
+    }
+    dev.wifiConnected = false;
+    if (dev.radio != hal::Radio::Off) dev.radio = hal::Radio::Idle;
+    if (active) fail(WL_DISCONNECTED, WIFI_REASON_ASSOC_LEAVE);
+    if (wifioff) mode(WIFI_MODE_NULL);
+    return true;
+}
+
+bool WiFiClass::setTxPower(wifi_power_t power) {
+    hal::Device& dev = hal::device();
+    if (dev.radio == hal::Radio::Off) return false;
+    dev.txPowerQdBm = power;
+    return true;
+}
+
+wifi_power_t WiFiClass::getTxPower() {
+    return (wifi_power_t)hal::device().txPowerQdBm;
+}
+
+// ============================================
+// Scan
+// ============================================
+int16_t WiFiClass::scanNetworks(bool async, bool) {
+    hal::Device& dev = hal::device();
+    const hal::WifiModel& model = hal::env().wifi;
+    mode(WIFI_STA);
+    scan_.clear();
+    uint32_t scan = ++scans_;
+    if (!async) {
+        hal::spendMs(model.scanMs, hal::Cpu::Idle, hal::Radio::Rx);
+        scanResults();
+        return scanState_;
+    }
+
+    scanState_ = WIFI_SCAN_RUNNING;
+    dev.radio = hal::Radio::Rx;
+    hal::post(dev.clockUs + (uint64_t)model.scanMs * 1000ULL, [this, scan]() {
+        if (scan != scans_) return;
+        hal::Device& dev = hal::device();
+        if (dev.radio == hal::Radio::Rx && !dev.wifiConnected) dev.radio = hal::Radio::Idle;
+        scanResults();
+        raise(ARDUINO_EVENT_WIFI_SCAN_DONE);
+    });
+    return WIFI_SCAN_RUNNING;
+}
+
+void WiFiClass::scanResults() {
+    const hal::WifiModel& model = hal::env().wifi;
+    scan_.clear();
+    if (model.apUp) {
+        for (hal::AccessPoint ap : model.aps) {
+            if (!ap.inRange) continue;
+            ap.rssi -= model.fadeDb;
+            scan_.push_back(ap);
+        }
+    }
+    scanState_ = (int16_t)scan_.size();
+}
+
+int16_t WiFiClass::scanComplete() {
+    return scanState_;
+}
+
+String WiFiClass::SSID(uint8_t index) {
+    return index < scan_.size() ? String(scan_[index].ssid.c_str()) : String();
+}
+
+int32_t WiFiClass::RSSI(uint8_t index) {
+    return index < scan_.size() ? scan_[index].rssi : 0;
+}
+
+int32_t WiFiClass::channel(uint8_t index) {
+    return index < scan_.size() ? scan_[index].channel : 0;
+}
+
+void WiFiClass::scanDelete() {
+    scan_.clear();
+    scanState_ = WIFI_SCAN_FAILED;
+}
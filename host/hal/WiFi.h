@@ -0,0 +1,133 @@
+#pragma once
+
+// Host fake of the Arduino-ESP32 WiFi station API
+#include <functional>
+#include <vector>
+
+#include "Arduino.h"
+
+typedef enum {
+    WL_NO_SHIELD       = 255,
+    WL_IDLE_STATUS     = 0,
+    WL_NO_SSID_AVAIL   = 1,
+    WL_SCAN_COMPLETED  = 2,
+    WL_CONNECTED       = 3,
+    WL_CONNECT_FAILED  = 4,
+    WL_CONNECTION_LOST = 5,
+    WL_DISCONNECTED    = 6
+} wl_status_t;
+
+typedef enum {
+    WIFI_MODE_NULL = 0,
+    WIFI_MODE_STA,
+    WIFI_MODE_AP,
+    WIFI_MODE_APSTA
+} wifi_mode_t;
+
+// Quarter-dBm, as the driver takes it
+typedef enum {
+    WIFI_POWER_19_5dBm = 78,
+    WIFI_POWER_19dBm   = 76,
+    WIFI_POWER_18_5dBm = 74,
+    WIFI_POWER_17dBm   = 68,
+    WIFI_POWER_15dBm   = 60,
+    WIFI_POWER_13dBm   = 52,
+    WIFI_POWER_11dBm   = 44,
+    WIFI_POWER_8_5dBm  = 34,
+    WIFI_POWER_7dBm    = 28,
+    WIFI_POWER_5dBm    = 20,
+    WIFI_POWER_2dBm    = 8,
+    WIFI_POWER_MINUS_1dBm = -4
+} wifi_power_t;
+
+#define WIFI_OFF    WIFI_MODE_NULL
+#define WIFI_STA    WIFI_MODE_STA
+
+class IPAddress {
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) : octets_{a, b, c, d} {}
+    String toString() const;
+
+private:
+    uint8_t octets_[4];
+};
+
+// Driver events, in the core's order; only those the fakes raise
+typedef enum {
+    ARDUINO_EVENT_WIFI_READY = 0,
+    ARDUINO_EVENT_WIFI_SCAN_DONE,
+    ARDUINO_EVENT_WIFI_STA_START,
+    ARDUINO_EVENT_WIFI_STA_STOP,
+    ARDUINO_EVENT_WIFI_STA_CONNECTED,
+    ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+    ARDUINO_EVENT_WIFI_STA_AUTHMODE_CHANGE,
+    ARDUINO_EVENT_WIFI_STA_GOT_IP,
+    ARDUINO_EVENT_MAX
+} arduino_event_id_t;
+
+// wifi_err_reason_t values for STA_DISCONNECTED
+#define WIFI_REASON_ASSOC_LEAVE         8   // WiFi.disconnect()
+#define WIFI_REASON_NO_AP_FOUND         201
+#define WIFI_REASON_ASSOC_FAIL          203
+#define WIFI_REASON_HANDSHAKE_TIMEOUT   204
+
+typedef struct {
+    uint8_t reason;
+} wifi_event_sta_disconnected_t;
+
+typedef union {
+    wifi_event_sta_disconnected_t wifi_sta_disconnected;
+} arduino_event_info_t;
+
+typedef std::function<void(arduino_event_id_t event, arduino_event_info_t info)> WiFiEventFuncCb;
+typedef uint16_t wifi_event_id_t;
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED  (-2)
+
+namespace hal { struct AccessPoint; }
+
+class WiFiClass {
+public:
+    // Returns at once, as on the chip: the scan (channel 0: every channel,
+    // otherwise that one) and the association run in virtual time and end
+    // in STA_GOT_IP or STA_DISCONNECTED
+    wl_status_t begin(const char* ssid, const char* passphrase = nullptr, int32_t channel = 0,
+                      const uint8_t* bssid = nullptr, bool connect = true);
+    wl_status_t status();
+    String      SSID() const;
+    int8_t      RSSI();
+    int32_t     channel();
+    IPAddress   localIP();
+    bool        mode(wifi_mode_t mode);
+    bool        disconnect(bool wifioff = false, bool eraseap = false);
+    // False while the radio is off, as on the chip
+    bool         setTxPower(wifi_power_t power);
+    wifi_power_t getTxPower();
+
+    // Handlers last until the next wake, as they last until reset on the chip
+    wifi_event_id_t onEvent(WiFiEventFuncCb cbEvent, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+
+    // Scan of every channel; results until scanDelete(). Async: returns
+    // WIFI_SCAN_RUNNING and raises SCAN_DONE when the results are in.
+    int16_t scanNetworks(bool async = false, bool showHidden = false);
+    int16_t scanComplete();             // count, WIFI_SCAN_RUNNING or WIFI_SCAN_FAILED
+    String  SSID(uint8_t index);
+    int32_t RSSI(uint8_t index);
+    int32_t channel(uint8_t index);
+    void    scanDelete();
+
+private:
+    void associate(const hal::AccessPoint& ap, uint32_t attempt);
+    void fail(wl_status_t status, uint8_t reason);
+    void raise(arduino_event_id_t event, uint8_t reason = 0);
+    void scanResults();
+
+    wl_status_t status_  = WL_IDLE_STATUS;
+    uint32_t    attempt_ = 0;       // begin() calls; stale posted work checks it
+    std::vector<hal::AccessPoint> scan_;
+    uint32_t    scans_    = 0;      // async scans started; a stale one checks it
+    int16_t     scanState_ = WIFI_SCAN_FAILED;
+};
+
+extern WiFiClass WiFi;
@@ -0,0 +1,28 @@
+#include "WiFiClientSecure.h"
+#include "hal.h"
+
+// The session lives on the device, so it ends with the wake or the link
+uint8_t WiFiClient::connected() {
+    const hal::Device& dev = hal::device();
+    return dev.tlsOpen && dev.wifiConnected;
+}
+
+void WiFiClient::stop() {
+    hal::device().tlsOpen = false;
+}
+
+int WiFiClientSecure::connect(const char*, uint16_t, int32_t timeout) {
+    hal::Device& dev = hal::device();
+    const hal::ServerModel& server = hal::env().server;
+
+    dev.tlsOpen = false;
+    if (!dev.wifiConnected) return 0;
+    hal::spendMs(server.dnsMs, hal::Cpu::Idle, hal::Radio::Rx);
+    if (!server.up) {
+        hal::spendMs((uint32_t)timeout, hal::Cpu::Idle, hal::Radio::Idle);
+        return 0;
+    }
+    hal::spendMs(server.tlsMs, hal::Cpu::Active, hal::Radio::Rx);
+    dev.tlsOpen = dev.wifiConnected;
+    return dev.tlsOpen;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+// Host fake of WiFiClientSecure: only the connect, for a session the
+// HTTPClient fake then reuses. Costs come from the scenario's server model.
+#include "WiFi.h"
+
+class WiFiClient {
+public:
+    uint8_t connected();
+    void    stop();
+};
+
+class WiFiClientSecure : public WiFiClient {
+public:
+    // DNS, then TCP + TLS handshake
+    int  connect(const char* host, uint16_t port, int32_t timeout);
+    void setInsecure() {}
+};
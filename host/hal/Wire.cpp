@@ -0,0 +1,168 @@
+#include "Wire.h"
+#include "hal.h"
+
+#include <cmath>
+
+TwoWire Wire;
+
+// Datasheet temperature calibration of a BME280 (section 8.1 example)
+static const int32_t BME_T1 = 27504;
+static const int32_t BME_T2 = 26435;
+static const int32_t BME_T3 = -1000;
+
+// BME280_compensate_T_int32, 0.01 degC
+static int32_t bmeCompensate(int32_t adc) {
+    int32_t var1 = ((((adc >> 3) - (BME_T1 << 1))) * BME_T2) >> 11;
+    int32_t delta = (adc >> 4) - BME_T1;
+    int32_t var2 = (((delta * delta) >> 12) * BME_T3) >> 14;
+    return ((var1 + var2) * 5 + 128) >> 8;
+}
+
+// The ADC value that compensates to c: rising over the whole range, so
+// a bisection finds it
+static uint32_t bmeAdcFor(float c) {
+    int32_t centi = (int32_t)lroundf(c * 100.0f);
+    uint32_t lo = 0, hi = (1u << 20) - 1;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (bmeCompensate((int32_t)mid) < centi) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static uint8_t crc8(const uint8_t* data, size_t len) {
+    uint8_t crc = 0xFF;
+    while (len--) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+// 9 clocks per byte, address byte included, at 100 kHz
+void TwoWire::transfer(size_t bytes) {
+    hal::spendUs((uint64_t)(bytes + 1) * 90ULL, hal::Cpu::Active);
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+    (void)sda;
+    (void)scl;
+    (void)frequency;
+    return true;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    address_ = address;
+    tx_.clear();
+}
+
+size_t TwoWire::write(uint8_t data) {
+    tx_.push_back(data);
+    return 1;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+    (void)sendStop;
+    transfer(tx_.size());
+    if (!hal::env().sensor.present) return 2;
+    if (address_ == 0x44 || address_ == 0x45) {
+        sht3xCommand(sht3x_[address_ - 0x44]);
+        return 0;
+    }
+    if (address_ == 0x76 || address_ == 0x77) {
+        bme280Write(bme280_[address_ - 0x76]);
+        return 0;
+    }
+    return 2;
+}
+
+// Single-shot measurement, no clock stretching: 0x24 then the
+// repeatability. Typical times; the datasheet maximum is longer.
+void TwoWire::sht3xCommand(Sht3x& sensor) {
+    if (tx_.size() != 2 || tx_[0] != 0x24) return;
+    uint32_t typicalUs = tx_[1] == 0x00 ? 12500 : tx_[1] == 0x0B ? 4500 : 2500;
+    float c;
+    bool glitched;
+    sensor.failed = !hal::convertSensor(c, glitched);
+    float raw = (c + 45.0f) / 175.0f * 65535.0f;
+    sensor.raw = (uint16_t)lroundf(raw < 0 ? 0 : raw > 65535 ? 65535 : raw);
+    sensor.readyUs = hal::device().clockUs + typicalUs;
+}
+
+// Register pointer, or pointer + value. ctrl_meas with forced mode starts
+// a measurement; its result replaces the data registers once done.
+void TwoWire::bme280Write(Bme280& sensor) {
+    if (tx_.empty()) return;
+    sensor.reg = tx_[0];
+    if (tx_.size() < 2 || tx_[0] != 0xF4 || (tx_[1] & 0x03) != 0x01) return;
+    uint8_t oversampling = tx_[1] >> 5;
+    if (oversampling == 0) return;
+    float c;
+    bool glitched;
+    sensor.failed = !hal::convertSensor(c, glitched);
+    // 16 bits at x1, one more per doubling
+    uint32_t unused = oversampling >= 5 ? 0 : 5 - oversampling;
+    sensor.pending = bmeAdcFor(c) & ~((1u << unused) - 1);
+    sensor.readyUs = hal::device().clockUs + 1000 + 2000ULL * oversampling;
+}
+
+uint8_t TwoWire::bme280Read(Bme280& sensor, uint8_t quantity) {
+    if (sensor.readyUs && hal::device().clockUs >= sensor.readyUs) {
+        sensor.adc = sensor.pending;
+        sensor.readyUs = 0;
+    }
+    for (uint8_t i = 0; i < quantity; i++) {
+        uint8_t reg = (uint8_t)(sensor.reg + i);
+        uint8_t value = 0;
+        switch (reg) {
+            case 0x88: value = BME_T1 & 0xFF; break;
+            case 0x89: value = BME_T1 >> 8; break;
+            case 0x8A: value = BME_T2 & 0xFF; break;
+            case 0x8B: value = (BME_T2 >> 8) & 0xFF; break;
+            case 0x8C: value = BME_T3 & 0xFF; break;
+            case 0x8D: value = (BME_T3 >> 8) & 0xFF; break;
+            case 0xD0: value = 0x60; break;
+            case 0xF3: value = sensor.readyUs ? 0x08 : 0x00; break;
+            case 0xFA: value = (uint8_t)(sensor.adc >> 12); break;
+            case 0xFB: value = (uint8_t)(sensor.adc >> 4); break;
+            case 0xFC: value = (uint8_t)(sensor.adc << 4); break;
+        }
+        rx_.push_back(value);
+    }
+    return quantity;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity) {
+    rx_.clear();
+    rxPos_ = 0;
+    uint8_t got = 0;
+    if (!hal::env().sensor.present) {
+        got = 0;
+    } else if (address == 0x44 || address == 0x45) {
+        Sht3x& sensor = sht3x_[address - 0x44];
+        // Nothing measured, or not yet done: the sensor NACKs
+        if (sensor.readyUs && hal::device().clockUs >= sensor.readyUs && !sensor.failed && quantity == 6) {
+            uint8_t data[6] = { (uint8_t)(sensor.raw >> 8), (uint8_t)sensor.raw, 0, 0x80, 0x00, 0 };
+            data[2] = crc8(data, 2);
+            data[5] = crc8(data + 3, 2);
+            rx_.assign(data, data + 6);
+            sensor.readyUs = 0;
+            got = 6;
+        }
+    } else if (address == 0x76 || address == 0x77) {
+        Bme280& sensor = bme280_[address - 0x76];
+        // A broken bus fails the data read; begin() still got through
+        if (!(sensor.failed && sensor.reg == 0xFA)) got = bme280Read(sensor, quantity);
+    }
+    transfer(got);
+    return got;
+}
+
+int TwoWire::available() {
+    return (int)(rx_.size() - rxPos_);
+}
+
+int TwoWire::read() {
+    return rxPos_ < rx_.size() ? rx_[rxPos_++] : -1;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// Host fake of the I2C master, with the sensors of the scenario on the
+// bus: an SHT3x at 0x44/0x45 and a BME280 at 0x76/0x77, all reading the
+// same sensor model. Transfers cost virtual time at 100 kHz.
+#include <vector>
+
+#include "Arduino.h"
+
+class TwoWire {
+public:
+    bool    begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    void    beginTransmission(uint8_t address);
+    size_t  write(uint8_t data);
+    uint8_t endTransmission(bool sendStop = true);   // 0 = ACK, 2 = address NACK
+    uint8_t requestFrom(uint8_t address, uint8_t quantity);
+    int     available();
+    int     read();
+
+private:
+    struct Sht3x {
+        uint64_t readyUs = 0;       // 0: no measurement to read
+        bool     failed  = false;   // sensor disconnected: the read NACKs
+        uint16_t raw     = 0;
+    };
+    struct Bme280 {
+        uint8_t  reg     = 0;
+        uint64_t readyUs = 0;
+        uint32_t adc     = 0x80000; // reset value: no measurement yet
+        uint32_t pending = 0x80000;
+        bool     failed  = false;
+    };
+
+    void    transfer(size_t bytes);
+    void    sht3xCommand(Sht3x& sensor);
+    void    bme280Write(Bme280& sensor);
+    uint8_t bme280Read(Bme280& sensor, uint8_t quantity);
+
+    uint8_t address_ = 0;
+    std::vector<uint8_t> tx_;
+    std::vector<uint8_t> rx_;
+    size_t  rxPos_ = 0;
+    Sht3x   sht3x_[2];
+    Bme280  bme280_[2];
+};
+
+extern TwoWire Wire;
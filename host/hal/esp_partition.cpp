@@ -0,0 +1,19 @@
+#include "esp_partition.h"
+#include "hal.h"
+
+// Sector erases and page programs stall the CPU until the flash is done
+esp_err_t esp_partition_write(const esp_partition_t*, size_t, const void*, size_t size) {
+    hal::Device& dev = hal::device();
+    dev.flashProgramBytes += size;
+    dev.flashProgramOps++;
+    hal::spendUs((uint64_t)size * hal::env().fs.programUsPerKb / 1024ULL, hal::Cpu::Active);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t*, size_t, size_t size) {
+    hal::Device& dev = hal::device();
+    uint32_t sectors = (uint32_t)(size / 4096);
+    dev.flashEraseOps += sectors;
+    hal::spendMs(sectors * hal::env().fs.eraseMs, hal::Cpu::Active);
+    return ESP_OK;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+// Host fake of the ESP-IDF partition API. The LittleFS fake issues its
+// modelled program/erase traffic here, where esp_littlefs would.
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Arduino.h"
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP  = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_DATA_NVS    = 0x02,
+    ESP_PARTITION_SUBTYPE_DATA_SPIFFS = 0x82,
+} esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t    type;
+    esp_partition_subtype_t subtype;
+    uint32_t                address;
+    uint32_t                size;
+    char                    label[17];
+    bool                    encrypted;
+} esp_partition_t;
+
+extern "C" {
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t dst_offset, const void* src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+// Host fake of the SNTP client's sync notification
+#include <sys/time.h>
+
+typedef void (*sntp_sync_time_cb_t)(struct timeval* tv);
+
+// Called when configTime()'s sync sets the clock, from the SNTP task on
+// the chip; here from the posted work that ends the sync
+void sntp_set_time_sync_notification_cb(sntp_sync_time_cb_t callback);
@@ -0,0 +1,46 @@
+#include "freertos/event_groups.h"
+#include "hal.h"
+
+struct EventGroup {
+    EventBits_t bits = 0;
+};
+
+EventGroupHandle_t xEventGroupCreate() {
+    return new EventGroup();
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+    group->bits |= bits;
+    return group->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+    EventBits_t before = group->bits;
+    group->bits &= ~bits;
+    return before;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+    return group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bitsToWaitFor, BaseType_t clearOnExit,
+                                BaseType_t waitForAllBits, TickType_t ticksToWait) {
+    hal::Device& dev = hal::device();
+    uint64_t deadlineUs = ticksToWait == portMAX_DELAY ? UINT64_MAX : dev.clockUs + (uint64_t)ticksToWait * 1000ULL;
+    for (;;) {
+        EventBits_t set = group->bits & bitsToWaitFor;
+        if (waitForAllBits ? set == bitsToWaitFor : set != 0) {
+            EventBits_t bits = group->bits;
+            if (clearOnExit) group->bits &= ~bitsToWaitFor;
+            return bits;
+        }
+        // Nothing left that could set them: the rest of the timeout passes idle
+        uint64_t nextUs;
+        if (!hal::nextPostedUs(nextUs) || nextUs > deadlineUs) {
+            if (deadlineUs != UINT64_MAX) hal::spendUs(deadlineUs - dev.clockUs, hal::Cpu::Idle);
+            return group->bits;
+        }
+        hal::spendUs(nextUs > dev.clockUs ? nextUs - dev.clockUs : 0, hal::Cpu::Idle);
+    }
+}
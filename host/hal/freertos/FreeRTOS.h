@@ -0,0 +1,13 @@
+#pragma once
+
+// Host fake of the FreeRTOS types the firmware uses. One tick per
+// millisecond, as the ESP32 Arduino core configures it.
+#include <cstdint>
+
+typedef uint32_t TickType_t;
+typedef int32_t  BaseType_t;
+
+#define pdTRUE              1
+#define pdFALSE             0
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFFUL)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
@@ -0,0 +1,17 @@
+#pragma once
+
+// Host fake of FreeRTOS event groups
+#include "FreeRTOS.h"
+
+typedef uint32_t EventBits_t;
+typedef struct EventGroup* EventGroupHandle_t;
+
+EventGroupHandle_t xEventGroupCreate();
+EventBits_t        xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t        xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t        xEventGroupGetBits(EventGroupHandle_t group);
+
+// Waits in virtual time. Work posted by the fakes (hal::post) runs on the
+// way, so bits a driver event sets end the wait the moment they are set.
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bitsToWaitFor, BaseType_t clearOnExit,
+                                BaseType_t waitForAllBits, TickType_t ticksToWait);
@@ -0,0 +1,225 @@
+#include "hal.h"
+
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+// Bounds of the RTC_DATA_ATTR section, provided by the linker
+extern "C" __attribute__((weak)) uint8_t __start_rtc_data[];
+extern "C" __attribute__((weak)) uint8_t __stop_rtc_data[];
+
+namespace hal {
+
+static Environment s_env;
+static Device      s_defaultDevice;
+static Device*     s_device = &s_defaultDevice;
+
+Environment& env()    { return s_env; }
+Device&      device() { return *s_device; }
+
+// ============================================
+// RTC memory
+// ============================================
+static size_t rtcSize() {
+    return __start_rtc_data ? (size_t)(__stop_rtc_data - __start_rtc_data) : 0;
+}
+
+// Contents at power-on: the initializers, captured before any wake runs
+static const std::vector<uint8_t>& rtcImage() {
+    static const std::vector<uint8_t> image(__start_rtc_data, __start_rtc_data + rtcSize());
+    return image;
+}
+
+void select(Device& next) {
+    const std::vector<uint8_t>& image = rtcImage();
+    if (s_device == &next) return;
+    s_device->rtc.assign(__start_rtc_data, __start_rtc_data + rtcSize());
+    const std::vector<uint8_t>& rtc = next.rtc.empty() ? image : next.rtc;
+    if (rtcSize()) memcpy(__start_rtc_data, rtc.data(), rtcSize());
+    s_device = &next;
+}
+
+const char* bucketName(Bucket bucket) {
+    switch (bucket) {
+        case BUCKET_SLEEP:      return "sleep";
+        case BUCKET_BOOT:       return "boot";
+        case BUCKET_CPU_ACTIVE: return "cpu active";
+        case BUCKET_CPU_IDLE:   return "cpu idle";
+        case BUCKET_RADIO_IDLE: return "radio idle";
+        case BUCKET_RADIO_RX:   return "radio rx";
+        case BUCKET_RADIO_TX:   return "radio tx";
+        default:                return "?";
+    }
+}
+
+double Ledger::totalMah() const {
+    double total = 0;
+    for (int i = 0; i < BUCKET_COUNT; i++) total += mAus[i];
+    return total / 3.6e9;
+}
+
+// ============================================
+// Virtual time
+// ============================================
+static void charge(Ledger& ledger, Bucket bucket, uint64_t us, double mA) {
+    ledger.us[bucket]   += (double)us;
+    ledger.mAus[bucket] += (double)us * mA;
+}
+
+// radio: nullptr follows Device::radio, which posted work may change
+static void spendSpan(uint64_t us, Cpu cpu, const Radio* radioOrNull) {
+    Device& dev = device();
+    const PowerProfile& p = s_env.power;
+    Radio radio = radioOrNull ? *radioOrNull : dev.radio;
+
+    if (cpu == Cpu::Active) charge(dev.ledger, BUCKET_CPU_ACTIVE, us, p.cpuActiveMa);
+    else                    charge(dev.ledger, BUCKET_CPU_IDLE, us, p.cpuIdleMa);
+
+    switch (radio) {
+        case Radio::Off:  break;
+        case Radio::Idle: charge(dev.ledger, BUCKET_RADIO_IDLE, us, p.radioIdleMa); break;
+        case Radio::Rx:   charge(dev.ledger, BUCKET_RADIO_RX, us, p.radioRxMa); break;
+        case Radio::Tx: {
+            // PA current falls with the power asked for, down to the receiver's
+            double mA = p.radioTxMa - p.radioTxMaPerDb * (78 - dev.txPowerQdBm) / 4.0;
+            charge(dev.ledger, BUCKET_RADIO_TX, us, mA > p.radioRxMa ? mA : p.radioRxMa);
+            break;
+        }
+    }
+
+    dev.clockUs += us;
+}
+
+static void spend(uint64_t us, Cpu cpu, const Radio* radio) {
+    Device& dev = device();
+    uint64_t endUs = dev.clockUs + us;
+    while (!dev.posted.empty() && dev.posted.begin()->first <= endUs) {
+        auto next = dev.posted.begin();
+        if (next->first > dev.clockUs) spendSpan(next->first - dev.clockUs, cpu, radio);
+        std::function<void()> work = std::move(next->second);
+        dev.posted.erase(next);
+        work();
+    }
+    if (endUs > dev.clockUs) spendSpan(endUs - dev.clockUs, cpu, radio);
+}
+
+void spendUs(uint64_t us, Cpu cpu, Radio radio) {
+    spend(us, cpu, &radio);
+}
+
+void spendUs(uint64_t us, Cpu cpu) {
+    spend(us, cpu, nullptr);
+}
+
+void post(uint64_t atUs, std::function<void()> work) {
+    device().posted.emplace(atUs, std::move(work));
+}
+
+bool nextPostedUs(uint64_t& atUs) {
+    const Device& dev = device();
+    if (dev.posted.empty()) return false;
+    atUs = dev.posted.begin()->first;
+    return true;
+}
+
+uint64_t sinceBootUs() {
+    const Device& dev = device();
+    return dev.clockUs - dev.wakeStartUs;
+}
+
+bool wallClock(time_t* now) {
+    Device& dev = device();
+    if (dev.ntpPending && dev.clockUs >= dev.ntpDueUs) {
+        dev.ntpPending = false;
+        dev.timeValid = true;
+    }
+    if (!dev.timeValid) return false;
+    *now = (time_t)(dev.epochBase + (int64_t)(dev.clockUs / 1000000ULL));
+    return true;
+}
+
+// ============================================
+// Wake lifecycle
+// ============================================
+void beginWake() {
+    Device& dev = device();
+    dev.wakeStartUs   = dev.clockUs;
+    dev.sleepUs       = 0;
+    dev.ntpPending    = false;
+    dev.radio         = Radio::Off;
+    dev.wifiConnected = false;
+    dev.ssid.clear();
+    dev.rssi          = 0;
+    dev.channel       = 0;
+    dev.txPowerQdBm   = 78;
+    dev.tlsOpen       = false;
+    dev.wifiEventHandlers.clear();
+    dev.posted.clear();
+    dev.fsMounted     = false;
+    dev.serialBaud    = 0;
+
+    Ledger& ledger = dev.ledger;
+    uint64_t bootUs = (uint64_t)s_env.power.bootMs * 1000ULL;
+    charge(ledger, BUCKET_BOOT, bootUs, s_env.power.cpuActiveMa);
+    dev.clockUs += bootUs;
+    // setup() starts after the bootloader; millis() counts from here on
+    // the real chip too, so boot time is outside sinceBootUs().
+    dev.wakeStartUs = dev.clockUs;
+    ledger.wakes++;
+}
+
+void endWake() {
+    Device& dev = device();
+    uint64_t awake = dev.clockUs - dev.wakeStartUs + (uint64_t)s_env.power.bootMs * 1000ULL;
+    dev.ledger.awakeUs += awake;
+    dev.ledger.wakeMs.push_back((uint32_t)(awake / 1000ULL));
+    if (dev.wifiConnected && s_env.infrastructure) s_env.infrastructure->disassociate(dev.clockUs);
+    dev.radio = Radio::Off;
+    dev.wifiConnected = false;
+    dev.posted.clear();
+    dev.coldBoot = false;
+}
+
+void sleepFor(uint64_t us) {
+    Device& dev = device();
+    charge(dev.ledger, BUCKET_SLEEP, us, s_env.power.sleepUa / 1000.0);
+    dev.clockUs += us;
+}
+
+void powerCycle(int64_t epoch) {
+    Device& dev = device();
+    dev.epochBase = epoch - (int64_t)(dev.clockUs / 1000000ULL);
+    const std::vector<uint8_t>& image = rtcImage();
+    if (rtcSize()) memcpy(__start_rtc_data, image.data(), rtcSize());
+    dev.timeValid = false;
+    dev.sensorFresh = true;
+    dev.coldBoot = true;
+}
+
+// ============================================
+// Serial - blocking writes at the UART baud rate
+// ============================================
+void serialWrite(const char* data, size_t len) {
+    Device& dev = device();
+    if (dev.serialBaud == 0) return;
+    spendUs((uint64_t)len * 10ULL * 1000000ULL / dev.serialBaud, Cpu::Active);
+    if (dev.verbose) fwrite(data, 1, len, stdout);
+}
+
+// ============================================
+// Sensor - noise and glitches per conversion
+// ============================================
+bool convertSensor(float& tempC, bool& glitched) {
+    const SensorModel& sensor = s_env.sensor;
+    if (sensor.disconnected) return false;
+    // Drawn on every conversion so a glitch doesn't shift the noise sequence
+    static std::mt19937 rng(1);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    float noiseC = noise(rng) * sensor.noiseC;
+    glitched = sensor.glitch || unit(rng) < sensor.glitchRate;
+    tempC = glitched ? sensor.glitchC : sensor.tempC + noiseC;
+    return true;
+}
+
+} // namespace hal
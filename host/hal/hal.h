@@ -0,0 +1,245 @@
+#pragma once
+
+// ============================================
+// Host-side hardware model
+// Backs the Arduino/ESP32 fakes in this directory with a virtual clock
+// and a per-phase current ledger, so the firmware in src/ runs unmodified
+// under the simulator (env:native).
+// ============================================
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace hal {
+
+// What the CPU and the radio are doing while virtual time passes
+enum class Cpu : uint8_t { Active, Idle };
+enum class Radio : uint8_t { Off, Idle, Rx, Tx };
+
+// Ledger buckets - CPU and radio buckets overlap in time
+enum Bucket : uint8_t {
+    BUCKET_SLEEP,
+    BUCKET_BOOT,
+    BUCKET_CPU_ACTIVE,
+    BUCKET_CPU_IDLE,
+    BUCKET_RADIO_IDLE,
+    BUCKET_RADIO_RX,
+    BUCKET_RADIO_TX,
+    BUCKET_COUNT
+};
+
+const char* bucketName(Bucket bucket);
+
+// ============================================
+// Environment - everything outside the chip
+// The simulator rewrites this before every wake from its scenario.
+// ============================================
+struct PowerProfile {
+    double   sleepUa      = 10.0;   // deep sleep, RTC timer running
+    double   cpuActiveMa  = 45.0;   // 240 MHz, busy
+    double   cpuIdleMa    = 25.0;   // 240 MHz, idle task (delay/vTaskDelay)
+    double   radioIdleMa  = 30.0;   // associated, modem sleep between beacons
+    double   radioRxMa    = 95.0;   // scanning, listening, receiving
+    double   radioTxMa    = 190.0;  // transmitting at default (max) power
+    double   radioTxMaPerDb = 5.0;  // less per dB of TX power below that
+    uint32_t bootMs       = 250;    // ROM + bootloader + app load before setup()
+};
+
+struct AccessPoint {
+    std::string ssid;
+    int         channel = 6;
+    int         rssi    = -62;
+    bool        inRange = true;     // false: the device is at another site
+};
+
+struct WifiModel {
+    bool     apUp        = true;
+    uint32_t scanMs      = 2200;    // full active scan of all channels
+    uint32_t probeMs     = 170;     // active scan of one channel
+    uint32_t connectMs   = 900;     // auth + assoc + DHCP
+    uint32_t connectTxMs = 30;      // airtime spent transmitting during connect
+    int      fadeDb      = 0;       // path loss added to every AP, both ways
+    int      apSensitivityDbm = -85;// weakest station signal an AP associates
+    // Visible APs. A scenario without 'ap' lines gets the first of WIFI_NETWORKS.
+    std::vector<AccessPoint> aps;
+};
+
+struct ServerModel {
+    bool     up        = true;      // false: TCP connect times out
+    int      status    = 200;
+    uint32_t dnsMs     = 40;
+    uint32_t tlsMs     = 900;       // TCP + TLS handshake
+    uint32_t latencyMs = 250;       // request sent -> response received
+};
+
+struct NtpModel {
+    bool     reachable = true;
+    uint32_t syncMs    = 400;
+};
+
+struct SensorModel {
+    bool     present      = true;
+    bool     disconnected = false;  // found at begin(), reads fail (DEVICE_DISCONNECTED_C)
+    bool     glitch       = false;  // conversion returns glitchC instead of tempC
+    float    glitchC      = 150.0f;
+    float    tempC        = 21.0f;
+    uint32_t conversionMs = 700;    // 12-bit conversion, real silicon; halves per bit less
+    float    noiseC       = 0.0f;   // per-conversion gaussian noise, sigma
+    double   glitchRate   = 0.0;    // chance one conversion returns glitchC
+};
+
+struct FsModel {
+    bool     mountFails     = false;
+    bool     openFails      = false;
+    uint32_t mountMs        = 25;
+    uint32_t openMs         = 3;
+    uint32_t commitMs       = 2;     // close() after writes: CPU side of the commit
+    uint32_t eraseMs        = 40;    // 4 KB sector erase
+    uint32_t programUsPerKb = 2800;  // page program
+    uint32_t enduranceCycles = 100000; // rated erases per sector
+};
+
+// Shared infrastructure plugged in by fleet runs; single-device runs
+// leave it unset and use the fixed models above.
+class Infrastructure {
+public:
+    virtual ~Infrastructure() {}
+    // A station starts associating; may stretch connectMs. False: AP refuses.
+    virtual bool associate(uint64_t atUs, uint32_t& connectMs) = 0;
+    virtual void disassociate(uint64_t atUs) = 0;
+    // A request reaches the server after the handshake. Adds queueing
+    // and service time to latencyMs and may override status.
+    virtual void serve(uint64_t atUs, size_t bytes, int& status, uint32_t& latencyMs) = 0;
+};
+
+struct Environment {
+    Infrastructure* infrastructure = nullptr;
+    PowerProfile power;
+    WifiModel    wifi;
+    ServerModel  server;
+    NtpModel     ntp;
+    SensorModel  sensor;
+    FsModel      fs;
+};
+
+// ============================================
+// Ledger - where the charge went
+// ============================================
+struct Ledger {
+    double   us[BUCKET_COUNT]     = {};   // time spent per bucket
+    double   mAus[BUCKET_COUNT]   = {};   // charge per bucket, mA * us
+    uint32_t wakes                = 0;
+    uint64_t awakeUs              = 0;
+    std::vector<uint32_t> wakeMs;         // awake time of every wake
+
+    double mAh(Bucket bucket) const { return mAus[bucket] / 3.6e9; }
+    double totalMah() const;
+};
+
+// ============================================
+// Device - one simulated board
+// Holds the state that survives deep sleep (RTC clock, flash) and the
+// per-wake state the fakes reset on every boot.
+// ============================================
+struct HttpExchange {
+    uint64_t    startUs = 0;
+    uint64_t    endUs   = 0;
+    std::string url;
+    std::string payload;
+    int         status  = 0;
+};
+
+struct Device {
+    // Survives deep sleep
+    uint64_t clockUs     = 0;       // virtual monotonic time since power-on
+    int64_t  epochBase   = 0;       // wall clock at clockUs == 0
+    bool     timeValid   = false;   // RTC holds NTP time
+    bool     sensorFresh = true;    // DS18B20 has not converted since power-up
+    bool     coldBoot    = true;    // next wake is a power-on reset, not a timer wake
+    std::vector<uint8_t> rtc;       // RTC_DATA_ATTR variables while not selected
+    std::map<std::string, std::string> files;
+    uint64_t fsBytesWritten = 0;    // logical bytes handed to File::write
+    uint32_t fsWriteOps     = 0;    // files closed after writing
+    uint64_t flashProgramBytes = 0; // physical traffic from the LittleFS model
+    uint32_t flashProgramOps   = 0;
+    uint32_t flashEraseOps     = 0; // 4 KB sectors
+    uint32_t mdirFill          = 0; // bytes used in the active metadata block
+    uint64_t fsBytesRead       = 0;
+    int64_t  powerCutAfterBytes = -1; // File::write stores this many more bytes, then power fails
+
+    // Reset on every wake
+    uint64_t    wakeStartUs   = 0;
+    uint64_t    sleepUs       = 0;  // timer requested by esp_sleep_enable_timer_wakeup
+    bool        ntpPending    = false;
+    uint64_t    ntpDueUs      = 0;
+    Radio       radio         = Radio::Off;
+    bool        wifiConnected = false;
+    std::string ssid;
+    int         rssi          = 0;
+    int         channel       = 0;
+    int         txPowerQdBm   = 78; // esp_wifi_set_max_tx_power(), quarter-dBm
+    bool        tlsOpen       = false; // WiFiClientSecure has a session with the server
+    std::vector<std::function<void(int, uint8_t)>> wifiEventHandlers; // WiFi.onEvent(): event, reason
+    std::multimap<uint64_t, std::function<void()>> posted;   // hal::post(), by due time
+    bool        fsMounted     = false;
+    uint32_t    serialBaud    = 0;
+
+    Ledger ledger;
+    std::vector<HttpExchange> http;  // every request the device made
+    bool recordHttp = true;          // fleet runs keep counters only
+    uint32_t httpOk     = 0;
+    uint32_t httpFailed = 0;
+    bool verbose = false;
+    std::string serialInput;         // typed into the serial monitor, read by Serial.read()
+};
+
+// Thrown by esp_deep_sleep_start() to unwind setup()
+struct DeepSleep {};
+
+// Thrown by File::write when Device::powerCutAfterBytes runs out: the
+// bytes before the cut are on flash, nothing after it happens
+struct PowerCut {};
+
+Environment& env();
+Device&      device();
+void         select(Device& device);   // swaps RTC memory in and out
+
+// ============================================
+// Virtual time
+// ============================================
+void     spendUs(uint64_t us, Cpu cpu);
+void     spendUs(uint64_t us, Cpu cpu, Radio radio);
+inline void spendMs(uint32_t ms, Cpu cpu) { spendUs((uint64_t)ms * 1000ULL, cpu); }
+inline void spendMs(uint32_t ms, Cpu cpu, Radio radio) { spendUs((uint64_t)ms * 1000ULL, cpu, radio); }
+uint64_t sinceBootUs();
+bool     wallClock(time_t* now);    // false until NTP has set the RTC
+
+// Work the chip does on its own - the WiFi driver finishing an
+// association, say. spendUs() stops at atUs and runs it there, so its
+// events land in the middle of a delay() as they do on the chip.
+// Dropped at the end of the wake.
+void     post(uint64_t atUs, std::function<void()> work);
+bool     nextPostedUs(uint64_t& atUs);   // false: nothing posted
+
+// ============================================
+// Wake lifecycle - driven by the simulator
+// ============================================
+void beginWake();                   // boot cost, reset per-wake state
+void endWake();                     // close the awake interval in the ledger
+void sleepFor(uint64_t us);         // deep sleep between wakes
+void powerCycle(int64_t epoch);     // cold boot: RTC and sensor lose state
+
+// ============================================
+// Fake peripheral hooks
+// ============================================
+void serialWrite(const char* data, size_t len);
+
+// One conversion of the modelled sensor, for every sensor fake: tempC
+// plus noise, or glitchC (glitched). False while it is disconnected.
+bool convertSensor(float& tempC, bool& glitched);
+
+} // namespace hal
@@ -0,0 +1,303 @@
+// ============================================
+// backfill - replay device dumps into the ingest API
+// Readings from every dump are merged and deduplicated (see dump.h), cut
+// into batches in time order and POSTed by several workers at once under
+// a request rate limit. A checkpoint file records, per device, the time
+// up to which everything has been delivered, so an interrupted run picks
+// up where it stopped.
+// ============================================
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config.h"
+#include "dump.h"
+#include "http.h"
+#include "sim.h"
+
+namespace sim {
+
+typedef std::chrono::steady_clock Clock;
+
+static const int      MAX_ATTEMPTS      = 6;
+static const uint32_t FIRST_BACKOFF_MS  = 500;
+static const double   CHECKPOINT_EVERY_S = 1.0;
+
+static std::atomic<bool> s_interrupted(false);
+
+static void onSignal(int) { s_interrupted = true; }
+
+// Backoff that Ctrl-C cuts short
+static void pause(uint32_t ms) {
+    Clock::time_point until = Clock::now() + std::chrono::milliseconds(ms);
+    while (!s_interrupted && Clock::now() < until) std::this_thread::sleep_for(std::chrono::milliseconds(50));
+}
+
+struct BackfillOptions {
+    std::string url          = SERVER_URL;
+    size_t      batch        = 500;
+    int         concurrency  = 4;
+    double      rate         = 20.0;    // requests per second, 0: unlimited
+    uint32_t    timeoutMs    = HTTP_TIMEOUT_MS;
+    const char* checkpoint   = nullptr;
+    bool        dryRun       = false;
+};
+
+// ============================================
+// Checkpoint: "<device> <epoch>" per line
+// ============================================
+static std::map<std::string, int64_t> loadCheckpoint(const char* path) {
+    std::map<std::string, int64_t> marks;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        size_t space = line.rfind(' ');
+        if (space == std::string::npos) continue;
+        marks[line.substr(0, space)] = strtoll(line.c_str() + space + 1, nullptr, 10);
+    }
+    return marks;
+}
+
+// Written aside and renamed over, so a crash never leaves half a file
+static bool saveCheckpoint(const char* path, const std::map<std::string, int64_t>& marks) {
+    std::string tmp = std::string(path) + ".tmp";
+    FILE* out = fopen(tmp.c_str(), "w");
+    if (!out) return false;
+    fprintf(out, "# backfill checkpoint: per device, readings up to this Unix time are delivered\n");
+    for (const auto& mark : marks) fprintf(out, "%s %lld\n", mark.first.c_str(), (long long)mark.second);
+    bool ok = fclose(out) == 0;
+    return ok && rename(tmp.c_str(), path) == 0;
+}
+
+// ============================================
+// Payload - the per-reading schema of buildPayload(), in an array
+// ============================================
+static void appendJsonString(std::string& out, const std::string& text) {
+    out += '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    out += '"';
+}
+
+static std::string batchBody(const std::vector<Reading>& rows, size_t begin, size_t end,
+                             const std::vector<std::string>& devices) {
+    std::string body;
+    body.reserve((end - begin) * 100 + 2);
+    bool array = end - begin > 1;
+    if (array) body += '[';
+    char number[32];
+    char timestamp[20];
+    for (size_t i = begin; i < end; i++) {
+        const Reading& r = rows[i];
+        if (i > begin) body += ',';
+        formatIsoTime(r.epoch, timestamp);
+        snprintf(number, sizeof(number), "%.2f", r.tempC);
+        body += "{\"temperature\":";
+        body += number;
+        body += ",\"unit\":\"celsius\",\"timestamp\":\"";
+        body += timestamp;
+        body += "\",\"device\":";
+        appendJsonString(body, devices[r.device]);
+        body += '}';
+    }
+    if (array) body += ']';
+    return body;
+}
+
+// ============================================
+// Pacing: requests start at most 'rate' per second across all workers
+// ============================================
+class RateLimiter {
+public:
+    explicit RateLimiter(double rate) : interval_(rate > 0 ? std::chrono::duration<double>(1.0 / rate) : std::chrono::duration<double>(0)) {}
+
+    void acquire() {
+        if (interval_.count() <= 0) return;
+        Clock::time_point slot;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Clock::time_point now = Clock::now();
+            if (next_ < now) next_ = now;
+            slot = next_;
+            next_ += std::chrono::duration_cast<Clock::duration>(interval_);
+        }
+        std::this_thread::sleep_until(slot);
+    }
+
+private:
+    std::chrono::duration<double> interval_;
+    std::mutex                    mutex_;
+    Clock::time_point             next_;
+};
+
+// ============================================
+// Progress: batches finish out of order; the checkpoint only advances
+// over the contiguous prefix of finished batches
+// ============================================
+struct Progress {
+    std::mutex mutex;
+    std::vector<bool> done;
+    size_t prefix = 0;                          // batches [0, prefix) delivered
+    std::map<std::string, int64_t> marks;
+    Clock::time_point lastSave = Clock::now();
+    size_t delivered = 0;
+    size_t retries = 0;
+    std::string fatal;
+};
+
+static void finishBatch(Progress& progress, size_t index, const std::vector<Reading>& rows,
+                        const std::vector<std::string>& devices, size_t batch, const char* checkpoint) {
+    std::lock_guard<std::mutex> lock(progress.mutex);
+    progress.done[index] = true;
+    size_t before = progress.prefix;
+    while (progress.prefix < progress.done.size() && progress.done[progress.prefix]) progress.prefix++;
+    for (size_t b = before; b < progress.prefix; b++) {
+        for (size_t i = b * batch; i < std::min(rows.size(), (b + 1) * batch); i++) {
+            int64_t& mark = progress.marks[devices[rows[i].device]];
+            if (rows[i].epoch > mark) mark = rows[i].epoch;
+        }
+    }
+    if (checkpoint && progress.prefix > before &&
+        std::chrono::duration<double>(Clock::now() - progress.lastSave).count() >= CHECKPOINT_EVERY_S) {
+        saveCheckpoint(checkpoint, progress.marks);
+        progress.lastSave = Clock::now();
+    }
+}
+
+static bool retryable(int status) {
+    return status < 0 || status == 408 || status == 429 || status >= 500;
+}
+
+int backfillCommand(int argc, char** argv) {
+    BackfillOptions options;
+    const char* sinceArg = nullptr;
+    const char* untilArg = nullptr;
+    std::vector<std::string> specs;
+    for (int i = 0; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--url") == 0 && hasValue)                 options.url = argv[++i];
+        else if (strcmp(argv[i], "--batch") == 0 && hasValue)          options.batch = (size_t)atol(argv[++i]);
+        else if (strcmp(argv[i], "--concurrency") == 0 && hasValue)    options.concurrency = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--rate") == 0 && hasValue)           options.rate = atof(argv[++i]);
+        else if (strcmp(argv[i], "--checkpoint") == 0 && hasValue)     options.checkpoint = argv[++i];
+        else if (strcmp(argv[i], "--since") == 0 && hasValue)          sinceArg = argv[++i];
+        else if (strcmp(argv[i], "--until") == 0 && hasValue)          untilArg = argv[++i];
+        else if (strcmp(argv[i], "--dry-run") == 0)                    options.dryRun = true;
+        else specs.push_back(argv[i]);
+    }
+    int64_t since = INT64_MIN;
+    int64_t until = INT64_MAX;
+    Url url;
+    std::string error;
+    if (specs.empty() || options.batch == 0 || options.concurrency <= 0 ||
+        (sinceArg && !parseTimeBound(sinceArg, since)) || (untilArg && !parseTimeBound(untilArg, until))) {
+        fprintf(stderr,
+            "usage: backfill [--url URL] [--batch 500] [--concurrency 4] [--rate 20] [--checkpoint FILE]\n"
+            "                [--since T] [--until T] [--dry-run] DUMP...\n");
+        return 2;
+    }
+    if (!parseUrl(options.url, url, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 2;
+    }
+
+    DumpSet set;
+    if (!loadDumps(specs, false, since, until, set, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    // Resume: drop what an earlier run already delivered
+    Progress progress;
+    if (options.checkpoint) progress.marks = loadCheckpoint(options.checkpoint);
+    std::vector<Reading> rows;
+    rows.reserve(set.readings.size());
+    for (const Reading& r : set.readings) {
+        auto mark = progress.marks.find(set.devices[r.device]);
+        if (mark == progress.marks.end() || r.epoch > mark->second) rows.push_back(r);
+    }
+    size_t batches = (rows.size() + options.batch - 1) / options.batch;
+    fprintf(stderr, "%zu readings to send (%zu already delivered, %zu duplicates dropped) in %zu batch(es) to %s\n",
+        rows.size(), set.readings.size() - rows.size(), set.duplicates, batches, url.text.c_str());
+    if (options.dryRun || rows.empty()) return 0;
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    progress.done.assign(batches, false);
+    RateLimiter limiter(options.rate);
+    std::atomic<size_t> nextBatch(0);
+    auto started = Clock::now();
+
+    auto worker = [&]() {
+        HttpPoster poster(url, options.timeoutMs);
+        for (;;) {
+            size_t index = nextBatch++;
+            if (index >= batches || s_interrupted) return;
+            {
+                std::lock_guard<std::mutex> lock(progress.mutex);
+                if (!progress.fatal.empty()) return;
+            }
+            size_t begin = index * options.batch;
+            size_t end = std::min(rows.size(), begin + options.batch);
+            std::string body = batchBody(rows, begin, end, set.devices);
+
+            int status = -1;
+            std::string why;
+            uint32_t backoffMs = FIRST_BACKOFF_MS;
+            for (int attempt = 0; attempt < MAX_ATTEMPTS && !s_interrupted; attempt++) {
+                if (attempt > 0) {
+                    pause(backoffMs);
+                    backoffMs *= 2;
+                    std::lock_guard<std::mutex> lock(progress.mutex);
+                    progress.retries++;
+                }
+                limiter.acquire();
+                status = poster.post(body, why);
+                if (!retryable(status)) break;
+            }
+
+            if (status >= 200 && status < 300) {
+                finishBatch(progress, index, rows, set.devices, options.batch, options.checkpoint);
+                std::lock_guard<std::mutex> lock(progress.mutex);
+                progress.delivered += end - begin;
+            } else {
+                std::lock_guard<std::mutex> lock(progress.mutex);
+                if (progress.fatal.empty() && !s_interrupted) {
+                    progress.fatal = status < 0 ? why : "HTTP " + std::to_string(status);
+                }
+                return;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < options.concurrency; i++) workers.emplace_back(worker);
+    for (std::thread& t : workers) t.join();
+    if (options.checkpoint) saveCheckpoint(options.checkpoint, progress.marks);
+
+    double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+    printf("backfill: %zu of %zu readings delivered in %.1f s (%.0f/s), %zu retries\n",
+        progress.delivered, rows.size(), seconds, seconds > 0 ? progress.delivered / seconds : 0.0,
+        progress.retries);
+    if (!progress.fatal.empty() || s_interrupted) {
+        printf("backfill: stopped (%s); %s\n", s_interrupted ? "interrupted" : progress.fatal.c_str(),
+            options.checkpoint ? "run again with the same --checkpoint to resume" : "no --checkpoint given");
+        return 1;
+    }
+    return 0;
+}
+
+} // namespace sim
@@ -0,0 +1,123 @@
+// ============================================
+// bench - per-wake CPU hot paths against a stored baseline
+// Runs src/bench.cpp on the host, or compares a suite captured from the
+// target's serial output.
+// ============================================
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "sim.h"
+
+namespace sim {
+
+static std::vector<BenchResult> s_results;
+
+// Stable storage for names parsed from files
+static const char* intern(const std::string& name) {
+    static std::set<std::string> names;
+    return names.insert(name).first->c_str();
+}
+
+static void collect(const BenchResult& result) {
+    char line[80];
+    formatBenchLine(result, line, sizeof(line));
+    printf("%s\n", line);
+    s_results.push_back(result);
+}
+
+// Lines of the form formatBenchLine() writes; anything else is ignored,
+// so raw serial captures work as input
+static bool loadResults(const char* file, std::map<std::string, BenchResult>& results) {
+    std::ifstream in(file);
+    if (!in) {
+        fprintf(stderr, "cannot open %s\n", file);
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        char name[32];
+        double ns, allocs;
+        size_t at = line.find("bench ");
+        if (at == std::string::npos) continue;
+        if (sscanf(line.c_str() + at, "bench %31s %lf ns/op %lf allocs/op", name, &ns, &allocs) == 3) {
+            results[name] = { intern(name), ns, allocs };
+        }
+    }
+    return true;
+}
+
+static int compare(const std::vector<BenchResult>& current, const std::map<std::string, BenchResult>& baseline,
+                   double thresholdPct) {
+    int regressions = 0;
+    printf("\n%-14s %12s %12s %8s %10s %10s\n", "stage", "base ns/op", "ns/op", "delta", "base alloc", "allocs");
+    for (const BenchResult& now : current) {
+        auto base = baseline.find(now.name);
+        if (base == baseline.end()) {
+            printf("%-14s %12s %12.1f %8s %10s %10.2f  new\n", now.name, "-", now.nsPerOp, "-", "-", now.allocsPerOp);
+            continue;
+        }
+        double delta = 100.0 * (now.nsPerOp - base->second.nsPerOp) / base->second.nsPerOp;
+        bool slower = delta > thresholdPct;
+        bool moreAllocs = now.allocsPerOp > base->second.allocsPerOp + 0.01;
+        printf("%-14s %12.1f %12.1f %+7.1f%% %10.2f %10.2f%s\n", now.name, base->second.nsPerOp, now.nsPerOp,
+            delta, base->second.allocsPerOp, now.allocsPerOp,
+            slower || moreAllocs ? "  REGRESSION" : "");
+        regressions += slower || moreAllocs;
+    }
+    if (regressions) printf("\n%d stage(s) regressed (threshold %.0f%%)\n", regressions, thresholdPct);
+    return regressions ? 1 : 0;
+}
+
+int benchCommand(int argc, char** argv) {
+    const char* baselineFile = nullptr;
+    const char* resultsFile = nullptr;
+    const char* saveFile = nullptr;
+    double thresholdPct = 20.0;
+    for (int i = 0; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--baseline") == 0 && hasValue)       baselineFile = argv[++i];
+        else if (strcmp(argv[i], "--results") == 0 && hasValue)   resultsFile = argv[++i];
+        else if (strcmp(argv[i], "--save") == 0 && hasValue)      saveFile = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && hasValue) thresholdPct = atof(argv[++i]);
+        else {
+            fprintf(stderr, "usage: bench [--baseline FILE] [--results FILE] [--save FILE] [--threshold PCT]\n");
+            return 2;
+        }
+    }
+
+    if (resultsFile) {
+        std::map<std::string, BenchResult> captured;
+        if (!loadResults(resultsFile, captured)) return 2;
+        for (const auto& entry : captured) s_results.push_back(entry.second);
+    } else {
+        runBenchmarks(collect);
+    }
+
+    if (saveFile) {
+        FILE* out = fopen(saveFile, "w");
+        if (!out) {
+            fprintf(stderr, "cannot write %s\n", saveFile);
+            return 2;
+        }
+        for (const BenchResult& result : s_results) {
+            char line[80];
+            formatBenchLine(result, line, sizeof(line));
+            fprintf(out, "%s\n", line);
+        }
+        fclose(out);
+    }
+
+    if (!baselineFile) return 0;
+    std::map<std::string, BenchResult> baseline;
+    if (!loadResults(baselineFile, baseline)) return 2;
+    return compare(s_results, baseline, thresholdPct);
+}
+
+} // namespace sim
@@ -0,0 +1,503 @@
+#include "dump.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+namespace sim {
+
+static const char* DATA_NAME = "temperature_data.csv";
+static const char* LOG_NAME  = "thermometer.log";
+
+// ============================================
+// MappedFile
+// ============================================
+MappedFile::~MappedFile() {
+    if (data_ && size_) munmap((void*)data_, size_);
+}
+
+bool MappedFile::open(const std::string& path, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        error = "cannot stat " + path;
+        return false;
+    }
+    size_ = (size_t)st.st_size;
+    if (size_ > 0) {
+        void* map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            close(fd);
+            size_ = 0;
+            error = "cannot map " + path;
+            return false;
+        }
+        madvise(map, size_, MADV_SEQUENTIAL);
+        data_ = (const char*)map;
+    }
+    close(fd);
+    return true;
+}
+
+// ============================================
+// Time
+// ============================================
+// Days since 1970-01-01 of a proleptic Gregorian date (H. Hinnant)
+static int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = (unsigned)(y - era * 400);
+    unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+static void civilFromDays(int64_t z, int& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned doe = (unsigned)(z - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = (int)(yoe + era * 400 + (m <= 2));
+}
+
+static bool digits(const char* p, int count, unsigned& value) {
+    value = 0;
+    for (int i = 0; i < count; i++) {
+        if (p[i] < '0' || p[i] > '9') return false;
+        value = value * 10 + (unsigned)(p[i] - '0');
+    }
+    return true;
+}
+
+bool parseIsoTime(std::string_view text, int64_t& epoch) {
+    if (text.size() < 19) return false;
+    const char* p = text.data();
+    unsigned y, mo, d, h, mi, s;
+    if (!digits(p, 4, y) || p[4] != '-' || !digits(p + 5, 2, mo) || p[7] != '-' ||
+        !digits(p + 8, 2, d) || p[10] != 'T' || !digits(p + 11, 2, h) || p[13] != ':' ||
+        !digits(p + 14, 2, mi) || p[16] != ':' || !digits(p + 17, 2, s)) {
+        return false;
+    }
+    if (mo < 1 || mo > 12 || d < 1 || d > 31 || h > 23 || mi > 59 || s > 60) return false;
+    epoch = daysFromCivil(y, mo, d) * 86400 + h * 3600 + mi * 60 + s;
+    return true;
+}
+
+void formatIsoTime(int64_t epoch, char out[20]) {
+    int64_t days = epoch >= 0 ? epoch / 86400 : (epoch - 86399) / 86400;
+    int64_t secs = epoch - days * 86400;
+    int y;
+    unsigned m, d;
+    civilFromDays(days, y, m, d);
+    char text[48];
+    snprintf(text, sizeof(text), "%04d-%02u-%02uT%02u:%02u:%02u", y, m, d,
+        (unsigned)(secs / 3600), (unsigned)(secs / 60 % 60), (unsigned)(secs % 60));
+    memcpy(out, text, 19);
+    out[19] = '\0';
+}
+
+// ============================================
+// CRC-32 (reflected, 0xEDB88320)
+// ============================================
+uint32_t crc32(const char* data, size_t len) {
+    static uint32_t table[256];
+    if (table[1] == 0) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int bit = 0; bit < 8; bit++) c = (c >> 1) ^ (0xEDB88320UL & (0UL - (c & 1)));
+            table[i] = c;
+        }
+    }
+    uint32_t crc = 0xFFFFFFFFUL;
+    for (size_t i = 0; i < len; i++) crc = table[(crc ^ (uint8_t)data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// ============================================
+// CRC-16/CCITT-FALSE, the data file's row check (src/storage.cpp)
+// ============================================
+uint16_t crc16(const char* data, size_t len) {
+    static uint16_t table[256];
+    if (table[1] == 0) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint16_t c = (uint16_t)(i << 8);
+            for (int bit = 0; bit < 8; bit++) c = (c & 0x8000) ? (uint16_t)((c << 1) ^ 0x1021) : (uint16_t)(c << 1);
+            table[i] = c;
+        }
+    }
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) crc = (uint16_t)((crc << 8) ^ table[((crc >> 8) ^ (uint8_t)data[i]) & 0xFF]);
+    return crc;
+}
+
+static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// ============================================
+// Opening dumps
+// ============================================
+static std::string baseName(const std::string& path) {
+    std::string p = path;
+    while (p.size() > 1 && p.back() == '/') p.pop_back();
+    size_t slash = p.rfind('/');
+    return slash == std::string::npos ? p : p.substr(slash + 1);
+}
+
+static std::string parentName(const std::string& path) {
+    size_t slash = path.rfind('/');
+    return slash == std::string::npos ? "." : baseName(path.substr(0, slash));
+}
+
+static bool isDirectory(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static bool exists(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0;
+}
+
+// The body of a "#BEGIN export ... #END <lines> <crc>" console reply,
+// checked against its line count and CRC
+static bool consoleBody(std::string_view text, const std::string& path, std::string_view& body,
+                        std::string& error) {
+    size_t begin = text.find("#BEGIN export\n");
+    if (begin == std::string_view::npos) {
+        body = text;
+        return true;
+    }
+    size_t start = begin + strlen("#BEGIN export\n");
+    size_t end = text.find("\n#END ", start - 1);
+    if (end == std::string_view::npos) {
+        error = path + ": export reply has no #END (capture cut short?)";
+        return false;
+    }
+    body = text.substr(start, end + 1 - start);
+
+    // The mapping isn't NUL-terminated: copy the line out before scanning it
+    char trailer[48] = {};
+    text.copy(trailer, sizeof(trailer) - 1, end + 1);
+    unsigned lines = 0;
+    unsigned crc = 0;
+    if (sscanf(trailer, "#END %u %8x", &lines, &crc) != 2) {
+        error = path + ": malformed #END line";
+        return false;
+    }
+    size_t counted = 0;
+    for (char c : body) counted += c == '\n';
+    if (counted != lines || crc32(body.data(), body.size()) != crc) {
+        error = path + ": export reply fails its line count or CRC - capture again";
+        return false;
+    }
+    return true;
+}
+
+bool openDump(const std::string& spec, Dump& dump, std::string& error) {
+    std::string path = spec;
+    size_t eq = spec.find('=');
+    if (eq != std::string::npos && !exists(spec)) {
+        dump.device = spec.substr(0, eq);
+        path = spec.substr(eq + 1);
+    }
+    dump.source = path;
+
+    if (isDirectory(path)) {
+        if (dump.device.empty()) dump.device = baseName(path);
+        std::string dataPath = path + "/" + DATA_NAME;
+        std::string logPath = path + "/" + LOG_NAME;
+        if (!exists(dataPath) && !exists(logPath)) {
+            error = path + ": neither " + DATA_NAME + " nor " + LOG_NAME + " in this directory";
+            return false;
+        }
+        if (exists(dataPath)) {
+            if (!dump.dataFile.open(dataPath, error)) return false;
+            dump.data = dump.dataFile.text();
+        }
+        if (exists(logPath)) {
+            if (!dump.logFile.open(logPath, error)) return false;
+            dump.log = dump.logFile.text();
+        }
+        return true;
+    }
+
+    std::string name = baseName(path);
+    bool isLog = name.size() > 4 && name.compare(name.size() - 4, 4, ".log") == 0;
+    if (dump.device.empty()) {
+        bool firmwareName = name == DATA_NAME || name == LOG_NAME;
+        dump.device = firmwareName ? parentName(path) : name.substr(0, name.rfind('.'));
+    }
+
+    MappedFile& file = isLog ? dump.logFile : dump.dataFile;
+    if (!file.open(path, error)) return false;
+    std::string_view text = file.text();
+    // littlefs superblock: "littlefs" at offset 8 of block 0
+    if (text.size() >= 16 && text.compare(8, 8, "littlefs") == 0) {
+        error = path + ": raw LittleFS image - unpack it first (mklittlefs -u " + path + " <dir>) "
+                "or use 'pio run --target downloadfs', which extracts the files";
+        return false;
+    }
+    if (isLog) {
+        dump.log = text;
+        return true;
+    }
+    return consoleBody(text, path, dump.data, error);
+}
+
+// ============================================
+// Parsing
+// ============================================
+static size_t lineEnd(std::string_view text, size_t from) {
+    const void* nl = memchr(text.data() + from, '\n', text.size() - from);
+    return nl ? (size_t)((const char*)nl - text.data()) : text.size();
+}
+
+static size_t nextLine(std::string_view text, size_t from) {
+    size_t end = lineEnd(text, from);
+    return end < text.size() ? end + 1 : text.size();
+}
+
+static std::string_view trimCr(std::string_view line) {
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    return line;
+}
+
+// Fixed-point "-12.34" without strtod: bounded by the line, no locale
+static bool parseTemperature(std::string_view text, float& value) {
+    size_t i = 0;
+    bool negative = i < text.size() && text[i] == '-';
+    if (negative) i++;
+    int64_t whole = 0;
+    int64_t frac = 0;
+    int64_t scale = 1;
+    bool any = false;
+    for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; i++, any = true) whole = whole * 10 + (text[i] - '0');
+    if (i < text.size() && text[i] == '.') {
+        for (i++; i < text.size() && text[i] >= '0' && text[i] <= '9' && scale < 1000000; i++, any = true) {
+            frac = frac * 10 + (text[i] - '0');
+            scale *= 10;
+        }
+    }
+    if (!any || i != text.size()) return false;
+    double v = (double)whole + (double)frac / (double)scale;
+    value = (float)(negative ? -v : v);
+    return true;
+}
+
+// Timed row starting at 'at', if it is one
+static bool rowTime(std::string_view csv, size_t at, int64_t& epoch) {
+    return parseIsoTime(csv.substr(at, 19), epoch);
+}
+
+// First line start at or after 'at'
+static size_t lineStartFrom(std::string_view text, size_t at) {
+    if (at == 0 || text[at - 1] == '\n') return at;
+    return nextLine(text, at);
+}
+
+// Smallest line start from which a scan finds every row >= since
+static size_t seek(std::string_view csv, size_t lo, int64_t since) {
+    size_t hi = csv.size();
+    while (hi - lo > 4096) {
+        size_t at = lineStartFrom(csv, lo + (hi - lo) / 2);
+        int64_t epoch = 0;
+        while (at < hi && !rowTime(csv, at, epoch)) at = nextLine(csv, at);
+        if (at >= hi) break;               // only untimed rows up there: scan from lo
+        if (epoch < since) lo = nextLine(csv, at);
+        else hi = at;
+    }
+    return lo;
+}
+
+void parseReadings(std::string_view csv, uint32_t device, int64_t since, int64_t until,
+                   std::vector<Reading>& out, ParseStats& stats) {
+    if (csv.empty()) return;
+    size_t at = nextLine(csv, 0);           // header
+    if (since > INT64_MIN) at = seek(csv, at, since);
+
+    while (at < csv.size()) {
+        size_t end = lineEnd(csv, at);
+        std::string_view line = trimCr(csv.substr(at, end - at));
+        at = end < csv.size() ? end + 1 : end;
+        if (line.empty()) continue;
+        // No line ending: a write cut short by a power failure
+        if (end == csv.size()) {
+            stats.malformed++;
+            break;
+        }
+
+        // "time,temp[,temp2...],crc" - or "time,temp" from before the CRC column
+        size_t comma = line.find(',');
+        size_t last = line.rfind(',');
+        if (last != comma) {
+            uint16_t crc = 0;
+            bool hex = line.size() - last == 5;
+            for (size_t i = last + 1; hex && i < line.size(); i++) {
+                int digit = hexDigit(line[i]);
+                hex = digit >= 0;
+                crc = (uint16_t)(crc << 4 | (digit & 0xF));
+            }
+            if (!hex || crc16(line.data(), last) != crc) {
+                stats.malformed++;
+                continue;
+            }
+            line = line.substr(0, last);
+        }
+        // One temperature column per channel; empty where a channel failed
+        float tempC[MAX_CHANNELS];
+        bool present[MAX_CHANNELS];
+        uint8_t channels = 0;
+        bool parsed = comma != std::string_view::npos;
+        for (size_t at = comma; parsed && at != std::string_view::npos && channels < MAX_CHANNELS; channels++) {
+            size_t next = line.find(',', at + 1);
+            std::string_view field = line.substr(at + 1, next == std::string_view::npos ? next : next - at - 1);
+            present[channels] = !field.empty();
+            parsed = field.empty() || parseTemperature(field, tempC[channels]);
+            at = next;
+        }
+        if (!parsed) {
+            stats.malformed++;
+            continue;
+        }
+        int64_t epoch;
+        if (!parseIsoTime(line.substr(0, comma), epoch)) {
+            if (line.compare(0, 5, "boot-") == 0) stats.untimed++;
+            else stats.malformed++;
+            continue;
+        }
+        if (epoch < since) continue;
+        if (epoch >= until) break;
+        for (uint8_t ch = 0; ch < channels; ch++) {
+            if (present[ch]) out.push_back({ epoch, tempC[ch], device, ch });
+        }
+        stats.rows++;
+    }
+}
+
+void parseLog(std::string_view log, uint32_t device, int64_t since, int64_t until,
+              std::vector<LogEntry>& out, ParseStats& stats) {
+    int64_t last = INT64_MIN;
+    size_t at = 0;
+    while (at < log.size()) {
+        size_t end = lineEnd(log, at);
+        std::string_view line = trimCr(log.substr(at, end - at));
+        at = end < log.size() ? end + 1 : end;
+        if (line.empty()) continue;
+
+        size_t close = line.find("] ");
+        if (line[0] != '[' || close == std::string_view::npos) {
+            stats.malformed++;
+            continue;
+        }
+        int64_t epoch;
+        bool timed = close > 1 && parseIsoTime(line.substr(1, close - 1), epoch);
+        if (timed) last = epoch;
+        else stats.untimed++;
+        epoch = last;
+        // Untimed lines before any clock only make it into an unfiltered export
+        if (epoch == INT64_MIN ? since > INT64_MIN : epoch < since) continue;
+        if (epoch != INT64_MIN && epoch >= until) break;
+        out.push_back({ epoch, timed, device, line.substr(close + 2) });
+        stats.rows++;
+    }
+}
+
+// ============================================
+// Loading and merging
+// ============================================
+// Each dump's rows arrive in time order; merge the runs pairwise
+template <typename T, typename Less>
+static void mergeRuns(std::vector<T>& rows, std::vector<size_t> bounds, Less less) {
+    for (size_t i = 0; i + 1 < bounds.size(); i++) {
+        if (!std::is_sorted(rows.begin() + bounds[i], rows.begin() + bounds[i + 1], less)) {
+            std::stable_sort(rows.begin() + bounds[i], rows.begin() + bounds[i + 1], less);
+        }
+    }
+    while (bounds.size() > 2) {
+        std::vector<size_t> next;
+        for (size_t i = 0; i + 2 < bounds.size(); i += 2) {
+            std::inplace_merge(rows.begin() + bounds[i], rows.begin() + bounds[i + 1],
+                               rows.begin() + bounds[i + 2], less);
+            next.push_back(bounds[i]);
+        }
+        if (bounds.size() % 2 == 0) next.push_back(bounds[bounds.size() - 2]);
+        next.push_back(bounds.back());
+        bounds.swap(next);
+    }
+}
+
+bool parseTimeBound(const char* text, int64_t& epoch) {
+    if (parseIsoTime(text, epoch)) return true;
+    char* end = nullptr;
+    long long value = strtoll(text, &end, 10);
+    if (end == text || *end) return false;
+    epoch = value;
+    return true;
+}
+
+bool loadDumps(const std::vector<std::string>& specs, bool log, int64_t since, int64_t until,
+               DumpSet& set, std::string& error) {
+    std::map<std::string, uint32_t> deviceIds;
+    std::vector<size_t> bounds = { 0 };
+    for (const std::string& spec : specs) {
+        std::unique_ptr<Dump> dump(new Dump());
+        if (!openDump(spec, *dump, error)) return false;
+        auto id = deviceIds.emplace(dump->device, (uint32_t)set.devices.size());
+        if (id.second) set.devices.push_back(dump->device);
+
+        ParseStats stats;
+        size_t first = set.readings.size();
+        if (log) parseLog(dump->log, id.first->second, since, until, set.entries, stats);
+        else     parseReadings(dump->data, id.first->second, since, until, set.readings, stats);
+        // Channel 2 and up of a multi-bus node are devices of their own: "name/2"
+        for (size_t i = first; i < set.readings.size(); i++) {
+            Reading& r = set.readings[i];
+            if (r.channel == 0) continue;
+            std::string name = dump->device + "/" + std::to_string(r.channel + 1);
+            auto channelId = deviceIds.emplace(name, (uint32_t)set.devices.size());
+            if (channelId.second) set.devices.push_back(name);
+            r.device = channelId.first->second;
+        }
+        bounds.push_back(log ? set.entries.size() : set.readings.size());
+        fprintf(stderr, "%s (%s): %zu %s, %zu untimed, %zu malformed\n", dump->source.c_str(),
+            dump->device.c_str(), stats.rows, log ? "lines" : "rows", stats.untimed, stats.malformed);
+        set.dumps.push_back(std::move(dump));
+    }
+
+    if (log) {
+        mergeRuns(set.entries, bounds, [](const LogEntry& a, const LogEntry& b) { return a.epoch < b.epoch; });
+        return true;
+    }
+    auto less = [](const Reading& a, const Reading& b) {
+        return a.epoch != b.epoch ? a.epoch < b.epoch : a.device < b.device;
+    };
+    mergeRuns(set.readings, bounds, less);
+    // Overlapping dumps of one device: one reading per device and second
+    auto same = [](const Reading& a, const Reading& b) { return a.epoch == b.epoch && a.device == b.device; };
+    size_t before = set.readings.size();
+    set.readings.erase(std::unique(set.readings.begin(), set.readings.end(), same), set.readings.end());
+    set.duplicates = before - set.readings.size();
+    return true;
+}
+
+} // namespace sim
@@ -0,0 +1,107 @@
+#pragma once
+
+// ============================================
+// Device dumps - what comes off a node's flash
+// A dump is one device's files: a directory extracted by downloadfs, a
+// single data or log file, or an "export" reply captured from the serial
+// console. Files are memory-mapped and parsed in place.
+// ============================================
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sim {
+
+// Read-only mapping of a whole file
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path, std::string& error);
+    std::string_view text() const { return std::string_view(data_, size_); }
+
+private:
+    const char* data_ = nullptr;
+    size_t      size_ = 0;
+};
+
+// "2026-02-17T10:00:02" (UTC, as the firmware writes it) <-> Unix time
+bool parseIsoTime(std::string_view text, int64_t& epoch);
+void formatIsoTime(int64_t epoch, char out[20]);
+
+// CRC-32 as zlib computes it, the checksum in console replies
+uint32_t crc32(const char* data, size_t len);
+
+// CRC-16/CCITT-FALSE, checked on every data file row
+uint16_t crc16(const char* data, size_t len);
+
+struct Dump {
+    std::string      device;
+    std::string      source;
+    MappedFile       dataFile;
+    MappedFile       logFile;
+    std::string_view data;      // CSV, header included; empty if none
+    std::string_view log;       // log lines; empty if none
+};
+
+// spec is [device=]path. Without a name the device is the directory name,
+// or the file name when that isn't one of the firmware's own file names.
+bool openDump(const std::string& spec, Dump& dump, std::string& error);
+
+// Temperature columns a data row may have (TEMP_MAX_CHANNELS)
+static const uint8_t MAX_CHANNELS = 8;
+
+struct Reading {
+    int64_t  epoch;
+    float    tempC;
+    uint32_t device;    // index into the caller's device table
+    uint8_t  channel;   // 0-based temperature column of the row
+};
+
+struct LogEntry {
+    int64_t          epoch;     // untimed lines inherit the previous line's time
+    bool             timed;
+    uint32_t         device;
+    std::string_view message;
+};
+
+struct ParseStats {
+    size_t rows      = 0;   // kept
+    size_t untimed   = 0;   // "boot-N" rows: no clock yet, can't be placed
+    size_t malformed = 0;
+};
+
+// Rows with since <= epoch < until, in file order, one Reading per
+// channel with a value. Rows are appended by the firmware in time order,
+// so 'since' is found by bisecting the file and scanning stops at 'until'.
+void parseReadings(std::string_view csv, uint32_t device, int64_t since, int64_t until,
+                   std::vector<Reading>& out, ParseStats& stats);
+
+void parseLog(std::string_view log, uint32_t device, int64_t since, int64_t until,
+              std::vector<LogEntry>& out, ParseStats& stats);
+
+// Dumps opened and parsed together; a device name seen in several dumps
+// is one device
+struct DumpSet {
+    std::vector<std::unique_ptr<Dump>> dumps;   // stay mapped: log messages point into them
+    std::vector<std::string> devices;
+    std::vector<Reading>     readings;          // time order, one per device and second
+    std::vector<LogEntry>    entries;           // time order (with log = true)
+    size_t                   duplicates = 0;    // readings dropped as overlaps
+};
+
+// Opens every spec and merges its readings, or its log lines. Reports
+// each dump's counts on stderr.
+bool loadDumps(const std::vector<std::string>& specs, bool log, int64_t since, int64_t until,
+               DumpSet& set, std::string& error);
+
+// Unix time or "2026-02-17T10:00:00"
+bool parseTimeBound(const char* text, int64_t& epoch);
+
+} // namespace sim
@@ -0,0 +1,141 @@
+// ============================================
+// energy - battery life of one device under a scenario
+// ============================================
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+#include <string>
+
+#include "LittleFS.h"
+#include "scenario.h"
+#include "sim.h"
+
+namespace sim {
+
+static int countLines(const std::string& text) {
+    int lines = 0;
+    for (char c : text) {
+        if (c == '\n') lines++;
+    }
+    return lines;
+}
+
+// The device's filesystem as downloadfs would extract it
+static bool dumpFiles(const hal::Device& device, const char* dir) {
+    mkdir(dir, 0755);
+    for (const auto& file : device.files) {
+        std::string path = std::string(dir) + file.first;
+        FILE* out = fopen(path.c_str(), "wb");
+        if (!out) {
+            fprintf(stderr, "cannot write %s\n", path.c_str());
+            return false;
+        }
+        fwrite(file.second.data(), 1, file.second.size(), out);
+        fclose(out);
+    }
+    return true;
+}
+
+// Logical bytes against what the LittleFS model programmed and erased
+static void printFlashWear(const Scenario& scenario, const hal::Device& device) {
+    double wakes = device.ledger.wakes ? device.ledger.wakes : 1;
+    double days = (double)device.clockUs / 86400e6;
+    double amplification = device.fsBytesWritten ? (double)device.flashProgramBytes / device.fsBytesWritten : 0;
+    printf("Flash: %.0f B/wake stored, %.0f B/wake programmed (%.1fx), %.2f sector erases/wake\n",
+        device.fsBytesWritten / wakes, device.flashProgramBytes / wakes, amplification,
+        device.flashEraseOps / wakes);
+
+    double erasesPerDay = device.flashEraseOps / days;
+    double sectors = (double)(LittleFS.totalBytes() / 4096);
+    if (erasesPerDay > 0) {
+        printf("       %.0f erases/day over %.0f sectors -> worn out (%u cycles) in %.1f years\n",
+            erasesPerDay, sectors, scenario.base.fs.enduranceCycles,
+            sectors * scenario.base.fs.enduranceCycles / erasesPerDay / 365.0);
+    }
+}
+
+static void printReport(const Scenario& scenario, const hal::Device& device) {
+    const hal::Ledger& ledger = device.ledger;
+    double days = (double)device.clockUs / 86400e6;
+    double mAhPerDay = ledger.totalMah() / days;
+
+    printf("Scenario: %s\n", scenario.path.c_str());
+    printf("Simulated %.2f days, %u wakes\n\n", days, ledger.wakes);
+
+    printf("Awake per wake: mean %llu ms, p50 %u ms, p95 %u ms, max %u ms\n\n",
+        (unsigned long long)(ledger.awakeUs / 1000ULL / (ledger.wakes ? ledger.wakes : 1)),
+        percentile(ledger.wakeMs, 50), percentile(ledger.wakeMs, 95), percentile(ledger.wakeMs, 100));
+
+    printf("%-12s %14s %12s %7s\n", "phase", "time/day", "mAh/day", "share");
+    for (int b = 0; b < hal::BUCKET_COUNT; b++) {
+        hal::Bucket bucket = (hal::Bucket)b;
+        double seconds = ledger.us[bucket] / 1e6 / days;
+        double mAh = ledger.mAh(bucket) / days;
+        printf("%-12s %12.1f s %12.3f %6.1f%%\n", hal::bucketName(bucket), seconds, mAh,
+            mAhPerDay > 0 ? 100.0 * mAh / mAhPerDay : 0.0);
+    }
+    printf("%-12s %14s %12.3f\n\n", "total", "", mAhPerDay);
+
+    printf("Average current: %.3f mA\n", mAhPerDay / 24.0);
+    double lifeDays = scenario.batteryMah * scenario.batteryUsable / mAhPerDay;
+    printf("Battery: %.0f mAh x %.2f usable -> %.1f days (%.1f weeks)\n\n",
+        scenario.batteryMah, scenario.batteryUsable, lifeDays, lifeDays / 7.0);
+
+    int delivered = 0;
+    int failed = 0;
+    for (const hal::HttpExchange& exchange : device.http) {
+        if (exchange.status == 200) delivered++;
+        else failed++;
+    }
+    auto data = device.files.find("/temperature_data.csv");
+    int stored = data == device.files.end() ? 0 : countLines(data->second) - 1;
+    printf("Uploads: %d delivered, %d failed; %d readings in local CSV\n\n",
+        delivered, failed, stored > 0 ? stored : 0);
+
+    printFlashWear(scenario, device);
+}
+
+int energyCommand(int argc, char** argv) {
+    const char* file = nullptr;
+    const char* console = nullptr;
+    const char* dumpDir = nullptr;
+    bool verbose = false;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--verbose") == 0) verbose = true;
+        else if (strcmp(argv[i], "--console") == 0 && i + 1 < argc) console = argv[++i];
+        else if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc) dumpDir = argv[++i];
+        else file = argv[i];
+    }
+    if (!file) {
+        fprintf(stderr, "usage: energy <scenario> [--verbose] [--console 'cmd; cmd'] [--dump DIR]\n");
+        return 2;
+    }
+
+    Scenario scenario;
+    std::string error;
+    if (!scenario.load(file, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 2;
+    }
+
+    hal::Device device;
+    device.verbose = verbose;
+    // Typed into the monitor again whenever a console window has read it,
+    // so every cold boot gets the commands; ';' separates them
+    std::string typed;
+    if (console) {
+        for (const char* c = console; *c; c++) typed += *c == ';' ? '\n' : *c;
+        typed += '\n';
+    }
+    device.serialInput = typed;
+    if (!runScenario(scenario, device, [&](hal::Device& dev) {
+            if (dev.serialInput.empty()) dev.serialInput = typed;
+        })) {
+        return 1;
+    }
+
+    printReport(scenario, device);
+    return dumpDir && !dumpFiles(device, dumpDir) ? 1 : 0;
+}
+
+} // namespace sim
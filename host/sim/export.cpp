@@ -0,0 +1,264 @@
+// ============================================
+// export - device dumps to CSV, JSON lines or a columnar file
+// Merges any number of dumps (downloadfs directories, data/log files,
+// captured console exports) into one time-ordered stream, dropping rows
+// that overlapping dumps of the same device both contain.
+// ============================================
+#include <algorithm>
+#include <cinttypes>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "dump.h"
+#include "sim.h"
+
+namespace sim {
+
+// ============================================
+// Buffered output
+// ============================================
+class Output {
+public:
+    explicit Output(FILE* file) : file_(file) { buf_.reserve(CAPACITY); }
+    ~Output() { flush(); }
+
+    void put(const char* text, size_t len) {
+        if (buf_.size() + len > CAPACITY) flush();
+        buf_.append(text, len);
+    }
+    void put(const char* text)        { put(text, strlen(text)); }
+    void put(std::string_view text)   { put(text.data(), text.size()); }
+    void put(char c)                  { if (buf_.size() + 1 > CAPACITY) flush(); buf_ += c; }
+    void raw(const void* data, size_t len) { put((const char*)data, len); }
+
+    void flush() {
+        if (!buf_.empty()) fwrite(buf_.data(), 1, buf_.size(), file_);
+        buf_.clear();
+    }
+
+private:
+    static const size_t CAPACITY = 1 << 20;
+    FILE*       file_;
+    std::string buf_;
+};
+
+// Two decimals, as the firmware writes them
+static void putTemperature(Output& out, float tempC) {
+    char text[24];
+    char* end = text + sizeof(text);
+    char* p = end;
+    long centi = lroundf(tempC * 100.0f);
+    unsigned long v = (unsigned long)(centi < 0 ? -centi : centi);
+    *--p = (char)('0' + v % 10);
+    *--p = (char)('0' + v / 10 % 10);
+    *--p = '.';
+    v /= 100;
+    do *--p = (char)('0' + v % 10); while (v /= 10);
+    if (centi < 0) *--p = '-';
+    out.put(p, (size_t)(end - p));
+}
+
+// Rows of a day share the date: format it once per day, the time by hand
+static void putTime(Output& out, int64_t epoch) {
+    static int64_t cachedDay = INT64_MIN;
+    static char text[20];
+    int64_t day = epoch >= 0 ? epoch / 86400 : (epoch - 86399) / 86400;
+    if (day != cachedDay) {
+        formatIsoTime(day * 86400, text);
+        cachedDay = day;
+    }
+    unsigned secs = (unsigned)(epoch - day * 86400);
+    unsigned parts[3] = { secs / 3600, secs / 60 % 60, secs % 60 };
+    for (int i = 0; i < 3; i++) {
+        text[11 + i * 3] = (char)('0' + parts[i] / 10);
+        text[12 + i * 3] = (char)('0' + parts[i] % 10);
+    }
+    out.put(text, 19);
+}
+
+static void putJsonString(Output& out, std::string_view text) {
+    out.put('"');
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out.put('\\');
+            out.put(c);
+        } else if ((unsigned char)c < 0x20) {
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", (unsigned char)c);
+            out.put(esc);
+        } else {
+            out.put(c);
+        }
+    }
+    out.put('"');
+}
+
+static void putCsvField(Output& out, std::string_view text) {
+    if (text.find_first_of(",\"\n") == std::string_view::npos) {
+        out.put(text);
+        return;
+    }
+    out.put('"');
+    for (char c : text) {
+        if (c == '"') out.put('"');
+        out.put(c);
+    }
+    out.put('"');
+}
+
+// ============================================
+// Readings
+// ============================================
+static void writeCsv(Output& out, const std::vector<Reading>& rows, const std::vector<std::string>& devices) {
+    out.put("timestamp,device,temperature_celsius\n");
+    for (const Reading& r : rows) {
+        putTime(out, r.epoch);
+        out.put(',');
+        putCsvField(out, devices[r.device]);
+        out.put(',');
+        putTemperature(out, r.tempC);
+        out.put('\n');
+    }
+}
+
+static void writeJsonLines(Output& out, const std::vector<Reading>& rows, const std::vector<std::string>& devices) {
+    char epoch[24];
+    for (const Reading& r : rows) {
+        out.put("{\"timestamp\":\"");
+        putTime(out, r.epoch);
+        out.put("\",\"epoch\":");
+        out.put(epoch, (size_t)snprintf(epoch, sizeof(epoch), "%" PRId64, r.epoch));
+        out.put(",\"device\":");
+        putJsonString(out, devices[r.device]);
+        out.put(",\"temperature\":");
+        putTemperature(out, r.tempC);
+        out.put("}\n");
+    }
+}
+
+// Columnar file, little-endian:
+//   "TCOL" u32 version (1) u32 devices u64 rows
+//   devices x (u16 length, UTF-8 name)
+//   i64 epoch[rows]  f32 temperature[rows]  u16 device[rows]
+// Each column is one contiguous array, so numpy.frombuffer or any
+// column store reads it without parsing.
+static void writeColumns(Output& out, const std::vector<Reading>& rows, const std::vector<std::string>& devices) {
+    uint32_t version = 1;
+    uint32_t deviceCount = (uint32_t)devices.size();
+    uint64_t rowCount = rows.size();
+    out.raw("TCOL", 4);
+    out.raw(&version, 4);
+    out.raw(&deviceCount, 4);
+    out.raw(&rowCount, 8);
+    for (const std::string& name : devices) {
+        uint16_t len = (uint16_t)std::min<size_t>(name.size(), 0xFFFF);
+        out.raw(&len, 2);
+        out.raw(name.data(), len);
+    }
+    for (const Reading& r : rows) out.raw(&r.epoch, 8);
+    for (const Reading& r : rows) out.raw(&r.tempC, 4);
+    for (const Reading& r : rows) {
+        uint16_t device = (uint16_t)r.device;
+        out.raw(&device, 2);
+    }
+}
+
+// ============================================
+// Log
+// ============================================
+static void writeLog(Output& out, const std::vector<LogEntry>& entries, const std::vector<std::string>& devices,
+                     bool json) {
+    if (!json) out.put("timestamp,device,message\n");
+    for (const LogEntry& e : entries) {
+        if (json) {
+            out.put("{\"timestamp\":");
+            if (e.timed) {
+                out.put('"');
+                putTime(out, e.epoch);
+                out.put('"');
+            } else {
+                out.put("null");
+            }
+            out.put(",\"device\":");
+            putJsonString(out, devices[e.device]);
+            out.put(",\"message\":");
+            putJsonString(out, e.message);
+            out.put("}\n");
+        } else {
+            if (e.timed) putTime(out, e.epoch);
+            out.put(',');
+            putCsvField(out, devices[e.device]);
+            out.put(',');
+            putCsvField(out, e.message);
+            out.put('\n');
+        }
+    }
+}
+
+int exportCommand(int argc, char** argv) {
+    const char* format = "csv";
+    const char* outPath = nullptr;
+    int64_t since = INT64_MIN;
+    int64_t until = INT64_MAX;
+    const char* sinceArg = nullptr;
+    const char* untilArg = nullptr;
+    bool log = false;
+    std::vector<std::string> specs;
+    for (int i = 0; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--format") == 0 && hasValue)       format = argv[++i];
+        else if (strcmp(argv[i], "-o") == 0 && hasValue)        outPath = argv[++i];
+        else if (strcmp(argv[i], "--log") == 0)                 log = true;
+        else if (strcmp(argv[i], "--since") == 0 && hasValue)   sinceArg = argv[++i];
+        else if (strcmp(argv[i], "--until") == 0 && hasValue)   untilArg = argv[++i];
+        else specs.push_back(argv[i]);
+    }
+    if ((sinceArg && !parseTimeBound(sinceArg, since)) || (untilArg && !parseTimeBound(untilArg, until))) {
+        fprintf(stderr, "bad time bound: use Unix time or 2026-02-17T10:00:00\n");
+        return 2;
+    }
+    bool csv = strcmp(format, "csv") == 0;
+    bool jsonl = strcmp(format, "jsonl") == 0;
+    bool columns = strcmp(format, "columns") == 0;
+    if (specs.empty() || !(csv || jsonl || columns) || (log && columns)) {
+        fprintf(stderr,
+            "usage: export [--format csv|jsonl|columns] [--log] [--since T] [--until T] [-o FILE] DUMP...\n"
+            "  DUMP: [device=]path to a downloadfs directory, a data or .log file, or a console capture\n"
+            "  T:    Unix time or 2026-02-17T10:00:00 (UTC)\n");
+        return 2;
+    }
+
+    DumpSet set;
+    std::string error;
+    if (!loadDumps(specs, log, since, until, set, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    FILE* file = outPath ? fopen(outPath, columns ? "wb" : "w") : stdout;
+    if (!file) {
+        fprintf(stderr, "cannot write %s\n", outPath);
+        return 1;
+    }
+    {
+        Output out(file);
+        if (log)          writeLog(out, set.entries, set.devices, jsonl);
+        else if (csv)     writeCsv(out, set.readings, set.devices);
+        else if (jsonl)   writeJsonLines(out, set.readings, set.devices);
+        else              writeColumns(out, set.readings, set.devices);
+    }
+    if (outPath) fclose(file);
+
+    fprintf(stderr, "%zu %s from %zu device(s)", log ? set.entries.size() : set.readings.size(),
+        log ? "lines" : "rows", set.devices.size());
+    if (set.duplicates) fprintf(stderr, ", %zu duplicate(s) dropped", set.duplicates);
+    fprintf(stderr, "\n");
+    return 0;
+}
+
+} // namespace sim
@@ -0,0 +1,210 @@
+// ============================================
+// faults - what each failure mode costs
+// Runs fault scenarios and checks their 'expect' lines against awake time,
+// radio time, flash writes and data loss.
+// ============================================
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+#include "scenario.h"
+#include "sim.h"
+
+namespace sim {
+
+static const char* DATA_FILE = "/temperature_data.csv";
+
+static bool validTemperature(const char* text) {
+    char* end = nullptr;
+    double value = strtod(text, &end);
+    return end != text && value >= -55.0 && value <= 125.0;
+}
+
+// Rows in the data CSV whose temperature the firmware should have rejected
+static int invalidRows(const hal::Device& device) {
+    auto data = device.files.find(DATA_FILE);
+    if (data == device.files.end()) return 0;
+    int invalid = 0;
+    size_t start = data->second.find('\n');     // skip the header
+    while (start != std::string::npos && start + 1 < data->second.size()) {
+        size_t end = data->second.find('\n', start + 1);
+        std::string row = data->second.substr(start + 1, end - start - 1);
+        size_t comma = row.find(',');          // "time,temp,crc"
+        if (comma == std::string::npos || !validTemperature(row.c_str() + comma + 1)) invalid++;
+        start = end;
+    }
+    return invalid;
+}
+
+static const char* TEMPERATURE_KEY = "\"temperature\":";
+
+// Readings in one payload: an object, or an array of them
+static int payloadReadings(const std::string& payload) {
+    int readings = 0;
+    for (size_t at = payload.find(TEMPERATURE_KEY); at != std::string::npos;
+         at = payload.find(TEMPERATURE_KEY, at + 1)) {
+        readings++;
+    }
+    return readings;
+}
+
+// Uploads with a temperature the firmware should have rejected
+static int invalidUploads(const hal::Device& device) {
+    int invalid = 0;
+    for (const hal::HttpExchange& exchange : device.http) {
+        const std::string& payload = exchange.payload;
+        size_t at = payload.find(TEMPERATURE_KEY);
+        bool bad = at == std::string::npos;
+        for (; at != std::string::npos; at = payload.find(TEMPERATURE_KEY, at + 1)) {
+            bad |= !validTemperature(payload.c_str() + at + strlen(TEMPERATURE_KEY));
+        }
+        invalid += bad;
+    }
+    return invalid;
+}
+
+// Rows appended to the data CSV between two sizes, header not counted
+static int rowsAdded(const std::string& data, size_t before) {
+    int rows = 0;
+    for (size_t i = before; i < data.size(); i++) rows += data[i] == '\n';
+    return before == 0 && rows > 0 ? rows - 1 : rows;
+}
+
+// Temperature in the last row of the data CSV
+static bool lastRowTemperature(const std::string& data, double& value) {
+    if (data.size() < 2) return false;
+    size_t start = data.rfind('\n', data.size() - 2);
+    if (start == std::string::npos) return false;
+    size_t comma = data.find(',', start);
+    if (comma == std::string::npos) return false;
+    char* end = nullptr;
+    value = strtod(data.c_str() + comma + 1, &end);
+    return end != data.c_str() + comma + 1;
+}
+
+static std::map<std::string, double> measure(const Scenario& scenario, bool& ok) {
+    hal::Device device;
+
+    // Counted in readings, not wakes: a wake with UPLOAD_EVERY_N_READINGS
+    // above 1 may store and deliver several, or none (sample-only)
+    int delivered = 0;
+    int stored = 0;
+    int accounted = 0;
+    size_t httpBefore = 0;
+    size_t dataBefore = 0;
+    double errorMax = 0;
+    double errorSquares = 0;
+    int errorRows = 0;
+    ok = runScenario(scenario, device, [&](hal::Device& dev) {
+        auto data = dev.files.find(DATA_FILE);
+        size_t dataSize = data == dev.files.end() ? 0 : data->second.size();
+        int deliveredNow = 0;
+        for (size_t i = httpBefore; i < dev.http.size(); i++) {
+            if (dev.http[i].status == 200) deliveredNow += payloadReadings(dev.http[i].payload);
+        }
+        int storedNow = dataSize > dataBefore ? rowsAdded(data->second, dataBefore) : 0;
+        bool wasStored = storedNow > 0;
+        delivered += deliveredNow;
+        stored += storedNow;
+        accounted += deliveredNow > storedNow ? deliveredNow : storedNow;
+        // Stored value against the temperature the sensor model had this wake
+        double tempC;
+        if (wasStored && lastRowTemperature(data->second, tempC)) {
+            double error = fabs(tempC - hal::env().sensor.tempC);
+            if (error > errorMax) errorMax = error;
+            errorSquares += error * error;
+            errorRows++;
+        }
+        httpBefore = dev.http.size();
+        dataBefore = dataSize;
+    });
+
+    const hal::Ledger& ledger = device.ledger;
+    double wakes = ledger.wakes ? ledger.wakes : 1;
+    double radioUs = ledger.us[hal::BUCKET_RADIO_IDLE] + ledger.us[hal::BUCKET_RADIO_RX] +
+                     ledger.us[hal::BUCKET_RADIO_TX];
+
+    std::map<std::string, double> metrics;
+    metrics["wakes"]                 = ledger.wakes;
+    metrics["awake_mean_ms"]         = (double)ledger.awakeUs / 1000.0 / wakes;
+    metrics["awake_max_ms"]          = percentile(ledger.wakeMs, 100);
+    metrics["radio_ms_per_wake"]     = radioUs / 1000.0 / wakes;
+    metrics["flash_bytes_per_wake"]  = (double)device.fsBytesWritten / wakes;
+    metrics["flash_writes_per_wake"] = (double)device.fsWriteOps / wakes;
+    metrics["flash_erases_per_wake"] = (double)device.flashEraseOps / wakes;
+    metrics["write_amplification"]   = device.fsBytesWritten ?
+        (double)device.flashProgramBytes / (double)device.fsBytesWritten : 0.0;
+    metrics["delivered"]             = delivered;
+    metrics["stored"]                = stored;
+    // Readings still held in RTC memory when the run ends are not lost
+    accounted += heldCount();
+    metrics["lost"]                  = accounted < (int)ledger.wakes ? (int)ledger.wakes - accounted : 0;
+    metrics["invalid_rows"]          = invalidRows(device);
+    metrics["invalid_uploads"]       = invalidUploads(device);
+    metrics["temp_error_max"]        = errorMax;
+    metrics["temp_error_rms"]        = errorRows ? sqrt(errorSquares / errorRows) : 0.0;
+    metrics["mah_per_day"]           = ledger.totalMah() / ((double)device.clockUs / 86400e6);
+    return metrics;
+}
+
+static bool holds(double actual, const std::string& op, double bound) {
+    if (op == "<")  return actual < bound;
+    if (op == "<=") return actual <= bound;
+    if (op == "==") return actual == bound;
+    if (op == ">=") return actual >= bound;
+    if (op == ">")  return actual > bound;
+    return false;
+}
+
+int faultsCommand(int argc, char** argv) {
+    if (argc == 0) {
+        fprintf(stderr, "usage: faults <scenario>...\n");
+        return 2;
+    }
+
+    printf("%-28s %6s %9s %9s %8s %8s %9s %6s %6s %5s %8s\n", "scenario", "wakes", "awake ms", "max ms",
+        "radio ms", "flash B", "delivered", "stored", "lost", "bad", "mAh/day");
+
+    int failures = 0;
+    for (int i = 0; i < argc; i++) {
+        Scenario scenario;
+        std::string error;
+        if (!scenario.load(argv[i], error)) {
+            fprintf(stderr, "%s\n", error.c_str());
+            return 2;
+        }
+        bool ran;
+        std::map<std::string, double> m = measure(scenario, ran);
+        if (!ran) return 1;
+
+        const char* name = strrchr(argv[i], '/') ? strrchr(argv[i], '/') + 1 : argv[i];
+        printf("%-28s %6.0f %9.0f %9.0f %8.0f %8.1f %9.0f %6.0f %6.0f %5.0f %8.2f\n", name,
+            m["wakes"], m["awake_mean_ms"], m["awake_max_ms"], m["radio_ms_per_wake"],
+            m["flash_bytes_per_wake"], m["delivered"], m["stored"], m["lost"],
+            m["invalid_rows"] + m["invalid_uploads"], m["mah_per_day"]);
+
+        for (const Expectation& e : scenario.expectations) {
+            auto metric = m.find(e.metric);
+            if (metric == m.end()) {
+                printf("  %s:%d: unknown metric '%s'\n", argv[i], e.line, e.metric.c_str());
+                failures++;
+            } else if (!holds(metric->second, e.op, e.value)) {
+                printf("  %s:%d: FAILED expect %s %s %g (got %g)\n", argv[i], e.line,
+                    e.metric.c_str(), e.op.c_str(), e.value, metric->second);
+                failures++;
+            }
+        }
+    }
+
+    if (failures) {
+        printf("\n%d expectation(s) failed\n", failures);
+        return 1;
+    }
+    printf("\nall expectations hold\n");
+    return 0;
+}
+
+} // namespace sim
@@ -0,0 +1,185 @@
+// ============================================
+// fleet - many devices sharing one AP and one ingest server
+// ============================================
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <random>
+#include <string>
+
+#include "scenario.h"
+#include "sim.h"
+#include "site.h"
+
+namespace sim {
+
+static const uint64_t STORM_BIN_US  = 10ULL * 1000000ULL;
+static const double   STORM_FACTOR  = 3.0;
+
+struct FleetStats {
+    int retries = 0;     // requests made by a device whose previous request failed
+};
+
+// Requests per bin over the run, for rate peaks and storm detection
+static std::vector<int> binArrivals(const std::vector<uint64_t>& arrivalsUs, uint64_t binUs, uint64_t durationUs) {
+    std::vector<int> bins((size_t)(durationUs / binUs) + 1, 0);
+    for (uint64_t at : arrivalsUs) {
+        size_t bin = (size_t)(at / binUs);
+        if (bin < bins.size()) bins[bin]++;
+    }
+    return bins;
+}
+
+static void printReport(const Scenario& scenario, const std::vector<hal::Device>& devices,
+                        const Site& site, const FleetStats& stats) {
+    const FleetModel& fleet = scenario.fleet;
+    uint64_t durationUs = scenario.durationUs();
+    double days = (double)durationUs / 86400e6;
+
+    printf("Scenario: %s\n", scenario.path.c_str());
+    printf("Fleet: %d devices, %.2f days, interval %s, phase spread %.0f s, RTC drift +/-%.0f ppm\n\n",
+        fleet.devices, days,
+        fleet.intervalS > 0 ? (std::to_string((int)fleet.intervalS) + " s").c_str() : "firmware",
+        fleet.phaseSpreadS, fleet.rtcDriftPpm);
+
+    // Devices
+    std::vector<uint32_t> awakeMs;
+    std::vector<double> mAhPerDay;
+    uint32_t wakes = 0;
+    for (const hal::Device& device : devices) {
+        awakeMs.insert(awakeMs.end(), device.ledger.wakeMs.begin(), device.ledger.wakeMs.end());
+        mAhPerDay.push_back(device.ledger.totalMah() / ((double)device.clockUs / 86400e6));
+        wakes += device.ledger.wakes;
+    }
+    std::sort(mAhPerDay.begin(), mAhPerDay.end());
+    double meanMah = 0;
+    for (double m : mAhPerDay) meanMah += m;
+    meanMah /= mAhPerDay.empty() ? 1 : (double)mAhPerDay.size();
+    printf("Devices: %u wakes, awake p50 %u ms, p95 %u ms, max %u ms\n",
+        wakes, percentile(awakeMs, 50), percentile(awakeMs, 95), percentile(awakeMs, 100));
+    printf("         %.2f mAh/day mean (min %.2f, max %.2f) -> %.1f days on %.0f mAh\n\n",
+        meanMah, mAhPerDay.front(), mAhPerDay.back(),
+        scenario.batteryMah * scenario.batteryUsable / mAhPerDay.back(), scenario.batteryMah);
+
+    // Server
+    uint32_t ok = 0;
+    uint32_t failed = 0;
+    for (const hal::Device& device : devices) {
+        ok += device.httpOk;
+        failed += device.httpFailed;
+    }
+    std::vector<int> perSecond = binArrivals(site.arrivalsUs, 1000000ULL, durationUs);
+    std::vector<int> perMinute = binArrivals(site.arrivalsUs, 60000000ULL, durationUs);
+    printf("Server:  %zu requests reached ingest (%u ok, %u failed at the device, %d rejected by a full queue)\n",
+        site.arrivalsUs.size(), ok, failed, site.rejected);
+    printf("         rate %.2f req/s mean, peak %d in 1 s, peak %d in 1 min\n",
+        (double)site.arrivalsUs.size() / ((double)durationUs / 1e6),
+        *std::max_element(perSecond.begin(), perSecond.end()),
+        *std::max_element(perMinute.begin(), perMinute.end()));
+    printf("         latency p50 %u ms, p90 %u ms, p99 %u ms, max %u ms\n",
+        percentile(site.latencyMs, 50), percentile(site.latencyMs, 90),
+        percentile(site.latencyMs, 99), percentile(site.latencyMs, 100));
+    printf("         peak in flight %d, peak queue %d (of %d workers)\n\n",
+        Site::peakOverlap(site.inFlight), site.peakQueue, fleet.ingestWorkers);
+
+    // AP
+    printf("AP:      peak %d associated stations (limit %d), peak %d concurrent handshakes, %d refused\n\n",
+        Site::peakOverlap(site.stations), fleet.apMaxClients,
+        Site::peakOverlap(site.associating), site.refusedAssociations);
+
+    // Storms
+    std::vector<int> bins = binArrivals(site.arrivalsUs, STORM_BIN_US, durationUs);
+    double meanPerBin = (double)site.arrivalsUs.size() / (double)bins.size();
+    int storms = 0;
+    size_t worst = 0;
+    for (size_t i = 0; i < bins.size(); i++) {
+        if (bins[i] > STORM_FACTOR * meanPerBin) storms++;
+        if (bins[i] > bins[worst]) worst = i;
+    }
+    printf("Storms:  %d of %zu 10 s windows above %.0fx the mean rate; worst %.1fx at +%.0f s\n",
+        storms, bins.size(), STORM_FACTOR, meanPerBin > 0 ? bins[worst] / meanPerBin : 0.0,
+        (double)(worst * STORM_BIN_US) / 1e6);
+    printf("         %d requests were retries after a failed one\n", stats.retries);
+}
+
+int fleetCommand(int argc, char** argv) {
+    const char* file = nullptr;
+    int devicesOverride = 0;
+    for (int i = 0; i < argc; i++) {
+        if (strcmp(argv[i], "--devices") == 0 && i + 1 < argc) devicesOverride = atoi(argv[++i]);
+        else file = argv[i];
+    }
+    if (!file) {
+        fprintf(stderr, "usage: fleet <scenario> [--devices N]\n");
+        return 2;
+    }
+
+    Scenario scenario;
+    std::string error;
+    if (!scenario.load(file, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 2;
+    }
+    if (devicesOverride > 0) scenario.fleet.devices = devicesOverride;
+    const FleetModel& fleet = scenario.fleet;
+
+    Site site(fleet);
+    hal::env().infrastructure = &site;
+
+    std::mt19937 rng(scenario.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // Never resized: the HAL keeps a pointer to the selected device
+    std::vector<hal::Device> devices((size_t)fleet.devices);
+    std::vector<double> sleepScale(devices.size());
+    std::vector<uint64_t> previousUs(devices.size(), 0);
+    std::vector<bool> lastFailed(devices.size(), false);
+
+    typedef std::pair<uint64_t, size_t> Due;
+    std::priority_queue<Due, std::vector<Due>, std::greater<Due>> queue;
+    for (size_t i = 0; i < devices.size(); i++) {
+        hal::Device& device = devices[i];
+        device.recordHttp = false;
+        hal::select(device);
+        hal::powerCycle(scenario.startEpoch);
+        sleepScale[i] = 1.0 + (2.0 * unit(rng) - 1.0) * fleet.rtcDriftPpm / 1e6;
+        hal::sleepFor((uint64_t)(unit(rng) * fleet.phaseSpreadS * 1e6));
+        queue.push({ device.clockUs, i });
+    }
+
+    uint64_t overrideUs = (uint64_t)(fleet.intervalS * 1e6);
+    FleetStats stats;
+    while (!queue.empty() && queue.top().first < scenario.durationUs()) {
+        size_t i = queue.top().second;
+        queue.pop();
+        hal::Device& device = devices[i];
+        hal::select(device);
+
+        if (scenario.powerCycleBetween(previousUs[i], device.clockUs)) {
+            hal::powerCycle(scenario.startEpoch + (int64_t)(device.clockUs / 1000000ULL));
+        }
+        previousUs[i] = device.clockUs;
+        scenario.apply(device.clockUs, hal::env());
+        scenario.rollFaults(rng, hal::env());
+
+        uint32_t okBefore = device.httpOk;
+        uint32_t failedBefore = device.httpFailed;
+        if (!runWake(device, overrideUs, sleepScale[i])) return 1;
+        uint32_t ok = device.httpOk - okBefore;
+        uint32_t failed = device.httpFailed - failedBefore;
+        if (ok + failed > 0) {
+            if (lastFailed[i]) stats.retries++;
+            lastFailed[i] = failed > 0;
+        }
+        queue.push({ device.clockUs, i });
+    }
+    hal::env().infrastructure = nullptr;
+
+    printReport(scenario, devices, site, stats);
+    return 0;
+}
+
+} // namespace sim
@@ -0,0 +1,205 @@
+#include "http.h"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace sim {
+
+bool parseUrl(const std::string& text, Url& url, std::string& error) {
+    url = Url();
+    url.text = text;
+    size_t scheme = text.find("://");
+    if (scheme == std::string::npos) {
+        error = "bad URL " + text + ": expected http://host[:port]/path or https://...";
+        return false;
+    }
+    url.scheme = text.substr(0, scheme);
+    if (url.scheme != "http" && url.scheme != "https") {
+        error = "bad URL " + text + ": only http and https";
+        return false;
+    }
+    size_t hostStart = scheme + 3;
+    size_t pathStart = text.find('/', hostStart);
+    std::string authority = text.substr(hostStart, pathStart == std::string::npos ? std::string::npos : pathStart - hostStart);
+    url.path = pathStart == std::string::npos ? "/" : text.substr(pathStart);
+    url.port = url.scheme == "https" ? 443 : 80;
+    size_t colon = authority.rfind(':');
+    if (colon != std::string::npos) {
+        url.port = atoi(authority.c_str() + colon + 1);
+        authority.resize(colon);
+    }
+    url.host = authority;
+    if (url.host.empty() || url.port <= 0) {
+        error = "bad URL " + text;
+        return false;
+    }
+    return true;
+}
+
+HttpPoster::~HttpPoster() {
+    disconnect();
+}
+
+int HttpPoster::post(const std::string& body, std::string& error) {
+    return url_.scheme == "https" ? postCurl(body, error) : postPlain(body, error);
+}
+
+// ============================================
+// Plain HTTP, keep-alive
+// ============================================
+bool HttpPoster::connect(std::string& error) {
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* addrs = nullptr;
+    std::string port = std::to_string(url_.port);
+    if (getaddrinfo(url_.host.c_str(), port.c_str(), &hints, &addrs) != 0) {
+        error = "cannot resolve " + url_.host;
+        return false;
+    }
+    for (struct addrinfo* a = addrs; a; a = a->ai_next) {
+        fd_ = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd_ < 0) continue;
+        struct timeval tv = { (time_t)(timeoutMs_ / 1000), (suseconds_t)(timeoutMs_ % 1000 * 1000) };
+        setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd_, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        int one = 1;
+        setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (::connect(fd_, a->ai_addr, a->ai_addrlen) == 0) break;
+        close(fd_);
+        fd_ = -1;
+    }
+    freeaddrinfo(addrs);
+    if (fd_ < 0) error = "cannot connect to " + url_.host + ":" + port;
+    return fd_ >= 0;
+}
+
+void HttpPoster::disconnect() {
+    if (fd_ >= 0) close(fd_);
+    fd_ = -1;
+}
+
+static bool sendAll(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        data += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+// Reads until 'need' returns true or the peer closes; false on timeout/error
+template <typename Need>
+static bool receive(int fd, std::string& in, Need need) {
+    char buf[4096];
+    while (!need()) {
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) return false;
+        in.append(buf, (size_t)n);
+    }
+    return true;
+}
+
+int HttpPoster::postPlain(const std::string& body, std::string& error) {
+    // A kept-alive connection the server has since closed fails on first
+    // use: reconnect once before giving up
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool reused = fd_ >= 0;
+        if (!reused && !connect(error)) return -1;
+
+        std::string request = "POST " + url_.path + " HTTP/1.1\r\nHost: " + url_.host +
+            "\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) +
+            "\r\nConnection: keep-alive\r\n\r\n";
+        std::string in;
+        size_t headerEnd = std::string::npos;
+        bool ok = sendAll(fd_, request.data(), request.size()) && sendAll(fd_, body.data(), body.size()) &&
+                  receive(fd_, in, [&] { return (headerEnd = in.find("\r\n\r\n")) != std::string::npos; });
+        if (!ok) {
+            disconnect();
+            if (reused) continue;
+            error = "no response from " + url_.host;
+            return -1;
+        }
+
+        int status = 0;
+        if (sscanf(in.c_str(), "HTTP/1.%*d %d", &status) != 1) {
+            disconnect();
+            error = "malformed response";
+            return -1;
+        }
+
+        // Drain the body so the connection can carry the next request
+        std::string headers = in.substr(0, headerEnd);
+        for (char& c : headers) c = (char)tolower((unsigned char)c);
+        size_t bodyStart = headerEnd + 4;
+        size_t length = std::string::npos;
+        size_t at = headers.find("content-length:");
+        if (at != std::string::npos) length = strtoul(headers.c_str() + at + 15, nullptr, 10);
+        bool chunked = headers.find("transfer-encoding: chunked") != std::string::npos;
+        if (length != std::string::npos) {
+            ok = receive(fd_, in, [&] { return in.size() >= bodyStart + length; });
+        } else if (chunked) {
+            ok = receive(fd_, in, [&] { return in.find("\r\n0\r\n\r\n", bodyStart - 2) != std::string::npos; });
+        } else {
+            receive(fd_, in, [] { return false; });
+            ok = false;     // read to close: not reusable
+        }
+        if (!ok || headers.find("connection: close") != std::string::npos) disconnect();
+        return status;
+    }
+    return -1;
+}
+
+// ============================================
+// HTTPS via curl(1)
+// ============================================
+int HttpPoster::postCurl(const std::string& body, std::string& error) {
+    char timeout[16];
+    snprintf(timeout, sizeof(timeout), "%.1f", timeoutMs_ / 1000.0);
+    std::string command = std::string("curl -s -o /dev/null -w '%{http_code}' -X POST ") +
+        "-H 'Content-Type: application/json' --max-time " + timeout + " --data-binary @- '" + url_.text + "'";
+
+    // Body on stdin; the status code comes back through a temp file
+    char outPath[] = "/tmp/backfill-XXXXXX";
+    int outFd = mkstemp(outPath);
+    if (outFd < 0) {
+        error = "cannot create temp file";
+        return -1;
+    }
+    close(outFd);
+    command += std::string(" > ") + outPath;
+
+    FILE* pipe = popen(command.c_str(), "w");
+    if (!pipe) {
+        unlink(outPath);
+        error = "cannot run curl";
+        return -1;
+    }
+    fwrite(body.data(), 1, body.size(), pipe);
+    int rc = pclose(pipe);
+
+    int status = -1;
+    FILE* out = fopen(outPath, "r");
+    if (out) {
+        if (fscanf(out, "%d", &status) != 1) status = -1;
+        fclose(out);
+    }
+    unlink(outPath);
+    if (rc != 0 || status <= 0) {
+        error = "curl failed (exit " + std::to_string(WIFEXITED(rc) ? WEXITSTATUS(rc) : -1) + ")";
+        return -1;
+    }
+    return status;
+}
+
+} // namespace sim
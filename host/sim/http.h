@@ -0,0 +1,46 @@
+#pragma once
+
+// ============================================
+// Minimal HTTP/1.1 for the host tools
+// Plain http:// runs over a keep-alive socket. https:// goes through the
+// curl command-line tool, one process per request, so the host build
+// needs no TLS library.
+// ============================================
+#include <cstdint>
+#include <string>
+
+namespace sim {
+
+struct Url {
+    std::string scheme;     // "http" or "https"
+    std::string host;
+    int         port = 80;
+    std::string path;       // "/" at least
+    std::string text;       // as given
+};
+
+bool parseUrl(const std::string& text, Url& url, std::string& error);
+
+class HttpPoster {
+public:
+    HttpPoster(const Url& url, uint32_t timeoutMs) : url_(url), timeoutMs_(timeoutMs) {}
+    ~HttpPoster();
+    HttpPoster(const HttpPoster&) = delete;
+    HttpPoster& operator=(const HttpPoster&) = delete;
+
+    // POSTs a JSON body. Returns the status code, or -1 on a transport
+    // error with the reason in error.
+    int post(const std::string& body, std::string& error);
+
+private:
+    int  postPlain(const std::string& body, std::string& error);
+    int  postCurl(const std::string& body, std::string& error);
+    bool connect(std::string& error);
+    void disconnect();
+
+    Url      url_;
+    uint32_t timeoutMs_;
+    int      fd_ = -1;
+};
+
+} // namespace sim
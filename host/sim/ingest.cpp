@@ -0,0 +1,215 @@
+// ============================================
+// ingest - local stand-in for the ingest server
+// Accepts what the firmware and backfill send (one reading object or an
+// array of them), with configurable latency, failures and batch limit,
+// and counts unique and duplicate (device, timestamp) pairs. Prints a
+// summary on Ctrl-C.
+// ============================================
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "sim.h"
+
+namespace sim {
+
+struct IngestOptions {
+    int      port       = 8080;
+    uint32_t latencyMs  = 50;
+    double   failRate   = 0.0;      // share of requests answered 503
+    size_t   maxBatch   = 1000;     // larger arrays get 413
+    const char* outPath = nullptr;  // accepted readings, CSV
+};
+
+struct IngestStats {
+    std::mutex mutex;
+    std::set<std::pair<std::string, std::string>> seen;    // (device, timestamp)
+    uint64_t requests   = 0;
+    uint64_t readings   = 0;
+    uint64_t duplicates = 0;
+    uint64_t failed     = 0;    // 503s served
+    uint64_t rejected   = 0;    // 413/400s served
+    FILE*    out        = nullptr;
+};
+
+static std::atomic<bool> s_stop(false);
+
+static void onSignal(int) { s_stop = true; }
+
+// Value of "key":"..." starting the search at 'from'; empty if absent
+static std::string stringField(const std::string& body, const char* key, size_t from, size_t to) {
+    std::string pattern = std::string("\"") + key + "\":\"";
+    size_t at = body.find(pattern, from);
+    if (at == std::string::npos || at >= to) return "";
+    at += pattern.size();
+    size_t end = body.find('"', at);
+    return end == std::string::npos ? "" : body.substr(at, end - at);
+}
+
+// Readings in a body: one object, or an array of flat objects
+static bool parseReadings(const std::string& body, std::vector<std::pair<std::string, std::string>>& out) {
+    size_t at = body.find('{');
+    while (at != std::string::npos) {
+        size_t end = body.find('}', at);
+        if (end == std::string::npos) return false;
+        std::string device = stringField(body, "device", at, end);
+        std::string timestamp = stringField(body, "timestamp", at, end);
+        if (device.empty() || timestamp.empty() || body.find("\"temperature\":", at) > end) return false;
+        out.emplace_back(device, timestamp);
+        at = body.find('{', end);
+    }
+    return !out.empty();
+}
+
+static void respond(int fd, int status, const char* reason, const std::string& body) {
+    std::string response = "HTTP/1.1 " + std::to_string(status) + " " + reason +
+        "\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) +
+        "\r\nConnection: keep-alive\r\n\r\n" + body;
+    send(fd, response.data(), response.size(), MSG_NOSIGNAL);
+}
+
+static void serveConnection(int fd, const IngestOptions& options, IngestStats& stats, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::string in;
+    char buf[8192];
+    while (!s_stop) {
+        // Headers, then Content-Length bytes of body
+        size_t headerEnd;
+        while ((headerEnd = in.find("\r\n\r\n")) == std::string::npos) {
+            struct pollfd p = { fd, POLLIN, 0 };
+            if (poll(&p, 1, 200) <= 0) {
+                if (s_stop) break;
+                continue;
+            }
+            ssize_t n = recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0) {
+                close(fd);
+                return;
+            }
+            in.append(buf, (size_t)n);
+        }
+        if (headerEnd == std::string::npos) break;
+
+        std::string headers = in.substr(0, headerEnd);
+        for (char& c : headers) c = (char)tolower((unsigned char)c);
+        size_t at = headers.find("content-length:");
+        size_t length = at == std::string::npos ? 0 : strtoul(headers.c_str() + at + 15, nullptr, 10);
+        while (in.size() < headerEnd + 4 + length) {
+            ssize_t n = recv(fd, buf, sizeof(buf), 0);
+            if (n <= 0) {
+                close(fd);
+                return;
+            }
+            in.append(buf, (size_t)n);
+        }
+        std::string body = in.substr(headerEnd + 4, length);
+        in.erase(0, headerEnd + 4 + length);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(options.latencyMs));
+
+        std::vector<std::pair<std::string, std::string>> readings;
+        bool fail = unit(rng) < options.failRate;
+        bool valid = !fail && parseReadings(body, readings);
+        std::lock_guard<std::mutex> lock(stats.mutex);
+        stats.requests++;
+        if (fail) {
+            stats.failed++;
+            respond(fd, 503, "Service Unavailable", "{\"error\":\"busy\"}");
+        } else if (!valid) {
+            stats.rejected++;
+            respond(fd, 400, "Bad Request", "{\"error\":\"expected reading objects\"}");
+        } else if (readings.size() > options.maxBatch) {
+            stats.rejected++;
+            respond(fd, 413, "Payload Too Large", "{\"error\":\"batch too large\"}");
+        } else {
+            for (const auto& r : readings) {
+                if (stats.seen.insert(r).second) {
+                    stats.readings++;
+                    if (stats.out) fprintf(stats.out, "%s,%s\n", r.second.c_str(), r.first.c_str());
+                } else {
+                    stats.duplicates++;
+                }
+            }
+            respond(fd, 200, "OK", "{\"accepted\":" + std::to_string(readings.size()) + "}");
+        }
+    }
+    close(fd);
+}
+
+int ingestCommand(int argc, char** argv) {
+    IngestOptions options;
+    for (int i = 0; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--port") == 0 && hasValue)              options.port = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--latency-ms") == 0 && hasValue)   options.latencyMs = (uint32_t)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--fail-rate") == 0 && hasValue)    options.failRate = atof(argv[++i]);
+        else if (strcmp(argv[i], "--max-batch") == 0 && hasValue)    options.maxBatch = (size_t)atol(argv[++i]);
+        else if (strcmp(argv[i], "-o") == 0 && hasValue)             options.outPath = argv[++i];
+        else {
+            fprintf(stderr, "usage: ingest [--port 8080] [--latency-ms 50] [--fail-rate 0] [--max-batch 1000] [-o FILE]\n");
+            return 2;
+        }
+    }
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)options.port);
+    if (bind(listener, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 64) != 0) {
+        fprintf(stderr, "cannot listen on 127.0.0.1:%d\n", options.port);
+        close(listener);
+        return 1;
+    }
+
+    IngestStats stats;
+    if (options.outPath && !(stats.out = fopen(options.outPath, "w"))) {
+        fprintf(stderr, "cannot write %s\n", options.outPath);
+        close(listener);
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    fprintf(stderr, "ingest: listening on http://127.0.0.1:%d/ (Ctrl-C for the summary)\n", options.port);
+
+    auto started = std::chrono::steady_clock::now();
+    std::vector<std::thread> connections;
+    uint32_t seed = 1;
+    while (!s_stop) {
+        struct pollfd p = { listener, POLLIN, 0 };
+        if (poll(&p, 1, 200) <= 0) continue;
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) continue;
+        connections.emplace_back(serveConnection, fd, std::cref(options), std::ref(stats), seed++);
+    }
+    close(listener);
+    for (std::thread& t : connections) t.join();
+    if (stats.out) fclose(stats.out);
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    printf("ingest: %llu requests, %llu readings stored, %llu duplicates, %llu answered 503, %llu rejected "
+           "(%.1f s)\n", (unsigned long long)stats.requests, (unsigned long long)stats.readings,
+           (unsigned long long)stats.duplicates, (unsigned long long)stats.failed,
+           (unsigned long long)stats.rejected, seconds);
+    return 0;
+}
+
+} // namespace sim
@@ -0,0 +1,53 @@
+// ============================================
+// Host simulator entry point (env:native)
+//
+//   program energy <scenario> [--verbose] [--console CMDS] [--dump DIR]
+//   program fleet <scenario> [--devices N]
+//   program faults <scenario>...
+//   program powercut <scenario>
+//   program bench [--baseline FILE] [--results FILE] [--save FILE]
+//   program export [--format csv|jsonl|columns] [--log] [--since T] [--until T] DUMP...
+//   program backfill [--url URL] [--batch N] [--concurrency N] [--rate R] [--checkpoint FILE] DUMP...
+//   program ingest [--port 8080] [--latency-ms 50] [--fail-rate P] [--max-batch N]
+// ============================================
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "sim.h"
+
+static int usage() {
+    fprintf(stderr,
+        "usage: program <command> [args]\n"
+        "  energy <scenario> [--verbose] [--console CMDS] [--dump DIR]\n"
+        "                                  battery life of one device\n"
+        "  fleet <scenario> [--devices N]  many devices sharing one AP and server\n"
+        "  faults <scenario>...            failure-mode metrics checked against 'expect' lines\n"
+        "  powercut <scenario>             cut power at every byte of a wake, check recovery\n"
+        "  bench [--baseline FILE] [--results FILE] [--save FILE] [--threshold PCT]\n"
+        "                                  CPU hot paths, ns/op and allocs/op\n"
+        "  export [--format csv|jsonl|columns] [--log] [--since T] [--until T] [-o FILE] DUMP...\n"
+        "                                  merge device dumps into one file\n"
+        "  backfill [--url URL] [--batch 500] [--concurrency 4] [--rate 20] [--checkpoint FILE]\n"
+        "           [--since T] [--until T] [--dry-run] DUMP...\n"
+        "                                  replay device dumps into the ingest API\n"
+        "  ingest [--port 8080] [--latency-ms 50] [--fail-rate P] [--max-batch 1000] [-o FILE]\n"
+        "                                  local stand-in for the ingest server\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    // Wall-clock formatting on the device is UTC
+    setenv("TZ", "UTC", 1);
+
+    if (argc < 2) return usage();
+    if (strcmp(argv[1], "energy") == 0) return sim::energyCommand(argc - 2, argv + 2);
+    if (strcmp(argv[1], "fleet") == 0) return sim::fleetCommand(argc - 2, argv + 2);
+    if (strcmp(argv[1], "faults") == 0) return sim::faultsCommand(argc - 2, argv + 2);
+    if (strcmp(argv[1], "powercut") == 0) return sim::powercutCommand(argc - 2, argv + 2);
+    if (strcmp(argv[1], "bench") == 0) return sim::benchCommand(argc - 2, argv + 2);
+    if (strcmp(argv[1], "export") == 0) return sim::exportCommand(argc - 2, argv + 2);
+    if (strcmp(argv[1], "backfill") == 0) return sim::backfillCommand(argc - 2, argv + 2);
+    if (strcmp(argv[1], "ingest") == 0) return sim::ingestCommand(argc - 2, argv + 2);
+    return usage();
+}
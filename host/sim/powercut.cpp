@@ -0,0 +1,144 @@
+// ============================================
+// powercut - cut power at every byte a wake writes
+// Runs the scenario to build up history, then replays the next wake once
+// per byte it writes to flash, failing the power after that byte. Each
+// time the device cold-boots, recovers and takes a reading, and the data
+// file and its index are checked:
+//   - the rows from before the cut wake are all still there
+//   - every row is whole and its CRC matches
+//   - every index entry points at the start of a row, in time order
+// ============================================
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "dump.h"
+#include "scenario.h"
+#include "sim.h"
+#include "storage.h"
+
+namespace sim {
+
+struct IndexEntry {
+    uint32_t epoch;
+    uint32_t offset;
+};
+
+static const std::string& fileOf(const hal::Device& device, const char* path) {
+    static const std::string empty;
+    auto it = device.files.find(path);
+    return it == device.files.end() ? empty : it->second;
+}
+
+// Empty when the files hold up; otherwise what is wrong
+static std::string checkFiles(const hal::Device& device, const std::string& before) {
+    const std::string& data = fileOf(device, DATA_FILE);
+    if (data.compare(0, before.size(), before) != 0) return "rows from before the cut are gone";
+    if (!data.empty() && data.back() != '\n') return "data file ends in a torn row";
+
+    std::vector<Reading> rows;
+    ParseStats stats;
+    parseReadings(data, 0, INT64_MIN, INT64_MAX, rows, stats);
+    if (stats.malformed) return std::to_string(stats.malformed) + " bad row(s) in the data file";
+
+    const std::string& index = fileOf(device, INDEX_FILE);
+    if (index.size() % sizeof(IndexEntry)) return "torn index entry";
+    uint32_t last = 0;
+    for (size_t at = 0; at < index.size(); at += sizeof(IndexEntry)) {
+        IndexEntry entry;
+        memcpy(&entry, index.data() + at, sizeof(entry));
+        if (entry.offset == 0 || entry.offset >= data.size() || data[entry.offset - 1] != '\n') {
+            return "index entry at " + std::to_string(entry.offset) + " is not a row start";
+        }
+        if (entry.epoch < last) return "index out of time order";
+        last = entry.epoch;
+    }
+    return "";
+}
+
+// The next wake of a copy of 'base', power failing after 'cutAfter' bytes
+// written (-1: no cut), then the recovery wake after it
+struct Trial {
+    hal::Device device;
+    bool        cut        = false;
+    uint64_t    written    = 0;     // bytes the (cut) wake wrote
+    uint64_t    recoverRead = 0;    // bytes read by the wake after it
+    size_t      tornAtCut  = 0;     // data file bytes after its last line ending
+};
+
+static Trial runTrial(const Scenario& scenario, const hal::Device& base, int64_t cutAfter) {
+    Trial trial;
+    trial.device = base;
+    hal::Device& dev = trial.device;
+    hal::select(dev);
+
+    scenario.apply(dev.clockUs, hal::env());
+    uint64_t written = dev.fsBytesWritten;
+    dev.powerCutAfterBytes = cutAfter;
+    runWake(dev);
+    trial.cut = dev.coldBoot;
+    trial.written = dev.fsBytesWritten - written;
+    const std::string& data = fileOf(dev, DATA_FILE);
+    size_t lineEnd = data.rfind('\n');
+    trial.tornAtCut = data.size() - (lineEnd == std::string::npos ? 0 : lineEnd + 1);
+
+    scenario.apply(dev.clockUs, hal::env());
+    uint64_t read = dev.fsBytesRead;
+    runWake(dev);
+    trial.recoverRead = dev.fsBytesRead - read;
+    return trial;
+}
+
+int powercutCommand(int argc, char** argv) {
+    if (argc != 1) {
+        fprintf(stderr, "usage: powercut <scenario>\n");
+        return 2;
+    }
+    Scenario scenario;
+    std::string error;
+    if (!scenario.load(argv[0], error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 2;
+    }
+
+    hal::Device base;
+    if (!runScenario(scenario, base)) return 1;
+    // Park the base device so its RTC memory is saved for the copies
+    hal::Device parking;
+    hal::select(parking);
+    const std::string before = fileOf(base, DATA_FILE);
+
+    Trial reference = runTrial(scenario, base, -1);
+    hal::select(parking);
+    if (!reference.cut && reference.written == 0) {
+        fprintf(stderr, "the wake after the scenario writes nothing\n");
+        return 1;
+    }
+
+    printf("%s: %zu B of data after %u wakes; the next wake writes %llu B\n",
+        scenario.path.c_str(), before.size(), base.ledger.wakes, (unsigned long long)reference.written);
+
+    int failures = 0;
+    size_t maxCut = 0;
+    uint64_t maxRead = 0;
+    for (uint64_t cutAfter = 0; cutAfter < reference.written; cutAfter++) {
+        Trial trial = runTrial(scenario, base, (int64_t)cutAfter);
+        hal::select(parking);
+        std::string problem = trial.cut ? checkFiles(trial.device, before) : "power was not cut";
+        if (!problem.empty()) {
+            if (failures++ < 10) printf("  cut after byte %llu: %s\n", (unsigned long long)cutAfter, problem.c_str());
+            continue;
+        }
+        if (trial.tornAtCut > maxCut) maxCut = trial.tornAtCut;
+        if (trial.recoverRead > maxRead) maxRead = trial.recoverRead;
+    }
+
+    printf("%llu cut points: %d failed\n", (unsigned long long)reference.written, failures);
+    printf("longest torn tail: %zu B; the recovery wake read at most %llu B (window %d B)\n",
+        maxCut, (unsigned long long)maxRead, DATA_RECOVERY_WINDOW);
+    return failures ? 1 : 0;
+}
+
+} // namespace sim
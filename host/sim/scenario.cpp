@@ -0,0 +1,280 @@
+#include "scenario.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+
+#include "config.h"
+
+namespace sim {
+
+bool parseDuration(const std::string& text, uint64_t& us) {
+    char* end = nullptr;
+    double value = strtod(text.c_str(), &end);
+    if (end == text.c_str() || value < 0) return false;
+    double unit = 1.0;
+    std::string suffix(end);
+    if (suffix.empty() || suffix == "s")  unit = 1.0;
+    else if (suffix == "ms")              unit = 0.001;
+    else if (suffix == "m")               unit = 60.0;
+    else if (suffix == "h")               unit = 3600.0;
+    else if (suffix == "d")               unit = 86400.0;
+    else return false;
+    us = (uint64_t)(value * unit * 1e6);
+    return true;
+}
+
+typedef std::function<void(Scenario&, double)> Setter;
+
+static const std::map<std::string, Setter>& setters() {
+    static const std::map<std::string, Setter> table = {
+        { "days",               [](Scenario& s, double v) { s.days = v; } },
+        { "battery_mah",        [](Scenario& s, double v) { s.batteryMah = v; } },
+        { "battery_usable",     [](Scenario& s, double v) { s.batteryUsable = v; } },
+        { "seed",               [](Scenario& s, double v) { s.seed = (uint32_t)v; } },
+        { "epoch",              [](Scenario& s, double v) { s.startEpoch = (int64_t)v; } },
+        { "power.sleep_ua",     [](Scenario& s, double v) { s.base.power.sleepUa = v; } },
+        { "power.cpu_active_ma",[](Scenario& s, double v) { s.base.power.cpuActiveMa = v; } },
+        { "power.cpu_idle_ma",  [](Scenario& s, double v) { s.base.power.cpuIdleMa = v; } },
+        { "power.radio_idle_ma",[](Scenario& s, double v) { s.base.power.radioIdleMa = v; } },
+        { "power.radio_rx_ma",  [](Scenario& s, double v) { s.base.power.radioRxMa = v; } },
+        { "power.radio_tx_ma",  [](Scenario& s, double v) { s.base.power.radioTxMa = v; } },
+        { "power.radio_tx_ma_per_db", [](Scenario& s, double v) { s.base.power.radioTxMaPerDb = v; } },
+        { "power.boot_ms",      [](Scenario& s, double v) { s.base.power.bootMs = (uint32_t)v; } },
+        { "wifi.scan_ms",       [](Scenario& s, double v) { s.base.wifi.scanMs = (uint32_t)v; } },
+        { "wifi.probe_ms",      [](Scenario& s, double v) { s.base.wifi.probeMs = (uint32_t)v; } },
+        { "wifi.connect_ms",    [](Scenario& s, double v) { s.base.wifi.connectMs = (uint32_t)v; } },
+        { "wifi.connect_tx_ms", [](Scenario& s, double v) { s.base.wifi.connectTxMs = (uint32_t)v; } },
+        { "wifi.ap_sensitivity_dbm", [](Scenario& s, double v) { s.base.wifi.apSensitivityDbm = (int)v; } },
+        { "server.status",      [](Scenario& s, double v) { s.base.server.status = (int)v; } },
+        { "server.dns_ms",      [](Scenario& s, double v) { s.base.server.dnsMs = (uint32_t)v; } },
+        { "server.tls_ms",      [](Scenario& s, double v) { s.base.server.tlsMs = (uint32_t)v; } },
+        { "server.latency_ms",  [](Scenario& s, double v) { s.base.server.latencyMs = (uint32_t)v; } },
+        { "ntp.sync_ms",        [](Scenario& s, double v) { s.base.ntp.syncMs = (uint32_t)v; } },
+        { "sensor.conversion_ms",[](Scenario& s, double v) { s.base.sensor.conversionMs = (uint32_t)v; } },
+        { "sensor.noise_c",     [](Scenario& s, double v) { s.base.sensor.noiseC = (float)v; } },
+        { "sensor.glitch_rate", [](Scenario& s, double v) { s.base.sensor.glitchRate = v; } },
+        { "sensor.glitch_c",    [](Scenario& s, double v) { s.base.sensor.glitchC = (float)v; } },
+        { "fs.mount_ms",        [](Scenario& s, double v) { s.base.fs.mountMs = (uint32_t)v; } },
+        { "fs.open_ms",         [](Scenario& s, double v) { s.base.fs.openMs = (uint32_t)v; } },
+        { "fs.commit_ms",       [](Scenario& s, double v) { s.base.fs.commitMs = (uint32_t)v; } },
+        { "fs.erase_ms",        [](Scenario& s, double v) { s.base.fs.eraseMs = (uint32_t)v; } },
+        { "fs.program_us_per_kb", [](Scenario& s, double v) { s.base.fs.programUsPerKb = (uint32_t)v; } },
+        { "fs.endurance",       [](Scenario& s, double v) { s.base.fs.enduranceCycles = (uint32_t)v; } },
+        { "temp.base",          [](Scenario& s, double v) { s.tempBase = (float)v; } },
+        { "temp.swing",         [](Scenario& s, double v) { s.tempSwing = (float)v; } },
+        { "fleet.devices",      [](Scenario& s, double v) { s.fleet.devices = (int)v; } },
+        { "fleet.interval_s",   [](Scenario& s, double v) { s.fleet.intervalS = v; } },
+        { "fleet.phase_spread_s",[](Scenario& s, double v) { s.fleet.phaseSpreadS = v; } },
+        { "fleet.rtc_drift_ppm",[](Scenario& s, double v) { s.fleet.rtcDriftPpm = v; } },
+        { "fleet.ap_max_clients",[](Scenario& s, double v) { s.fleet.apMaxClients = (int)v; } },
+        { "fleet.ap_assoc_penalty",[](Scenario& s, double v) { s.fleet.apAssocPenalty = v; } },
+        { "fleet.ingest_workers",[](Scenario& s, double v) { s.fleet.ingestWorkers = (int)v; } },
+        { "fleet.ingest_service_ms",[](Scenario& s, double v) { s.fleet.ingestServiceMs = (uint32_t)v; } },
+        { "fleet.ingest_queue_limit",[](Scenario& s, double v) { s.fleet.ingestQueueLimit = (int)v; } },
+    };
+    return table;
+}
+
+static const char* const EVENT_KINDS[] = {
+    "wifi_down", "wifi_slow", "wifi_fade", "ap_away", "server_down", "server_slow", "server_error",
+    "ntp_down", "sensor_missing", "sensor_disconnected", "sensor_out_of_range",
+    "fs_mount_fail", "fs_open_fail", "power_cycle",
+};
+
+static void applyCondition(const std::string& kind, long value, hal::Environment& env) {
+    if (kind == "wifi_down")                env.wifi.apUp = false;
+    else if (kind == "wifi_slow")           env.wifi.connectMs += (uint32_t)value;
+    else if (kind == "wifi_fade")           env.wifi.fadeDb += (int)value;
+    else if (kind == "ap_away") {
+        // value: the AP's position among the 'ap' lines, from 1
+        if (value >= 1 && (size_t)value <= env.wifi.aps.size()) env.wifi.aps[value - 1].inRange = false;
+    }
+    else if (kind == "server_down")         env.server.up = false;
+    else if (kind == "server_slow")         env.server.latencyMs = (uint32_t)value;
+    else if (kind == "server_error")        env.server.status = (int)value;
+    else if (kind == "ntp_down")            env.ntp.reachable = false;
+    else if (kind == "sensor_missing")      env.sensor.present = false;
+    else if (kind == "sensor_disconnected") env.sensor.disconnected = true;
+    else if (kind == "sensor_out_of_range") {
+        env.sensor.glitch = true;
+        if (value) env.sensor.glitchC = (float)value;
+    }
+    else if (kind == "fs_mount_fail")       env.fs.mountFails = true;
+    else if (kind == "fs_open_fail")        env.fs.openFails = true;
+}
+
+static bool knownEvent(const std::string& kind) {
+    for (const char* k : EVENT_KINDS) {
+        if (kind == k) return true;
+    }
+    return false;
+}
+
+static std::string directoryOf(const std::string& file) {
+    size_t slash = file.find_last_of('/');
+    return slash == std::string::npos ? std::string() : file.substr(0, slash + 1);
+}
+
+// "seconds,celsius" per line, linearly interpolated
+static bool loadTrace(const std::string& file, std::vector<TracePoint>& trace, std::string& error) {
+    std::ifstream in(file);
+    if (!in) {
+        error = "cannot open temperature trace " + file;
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        double seconds;
+        float tempC;
+        if (sscanf(line.c_str(), "%lf,%f", &seconds, &tempC) == 2) {
+            trace.push_back({ (uint64_t)(seconds * 1e6), tempC });
+        }
+    }
+    if (trace.empty()) {
+        error = "temperature trace " + file + " has no rows";
+        return false;
+    }
+    return true;
+}
+
+bool Scenario::load(const std::string& file, std::string& error) {
+    std::ifstream in(file);
+    if (!in) {
+        error = "cannot open " + file;
+        return false;
+    }
+    path = file;
+
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        lineNo++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+
+        std::istringstream words(line);
+        std::string key;
+        if (!(words >> key)) continue;
+
+        std::string where = file + ":" + std::to_string(lineNo) + ": ";
+        if (key == "at") {
+            std::string at, forWord, length;
+            Event event;
+            uint64_t lengthUs;
+            if (!(words >> at >> forWord >> length >> event.kind) || forWord != "for" ||
+                !parseDuration(at, event.startUs) || !parseDuration(length, lengthUs)) {
+                error = where + "expected 'at <time> for <duration> <event> [value]'";
+                return false;
+            }
+            if (!knownEvent(event.kind)) {
+                error = where + "unknown event '" + event.kind + "'";
+                return false;
+            }
+            words >> event.value;
+            event.endUs = event.startUs + lengthUs;
+            events.push_back(event);
+        } else if (key == "fault") {
+            Fault fault;
+            if (!(words >> fault.kind >> fault.probability) || fault.probability < 0 || fault.probability > 1) {
+                error = where + "expected 'fault <event> <probability> [value]'";
+                return false;
+            }
+            if (!knownEvent(fault.kind) || fault.kind == "power_cycle") {
+                error = where + "unknown fault '" + fault.kind + "'";
+                return false;
+            }
+            words >> fault.value;
+            faults.push_back(fault);
+        } else if (key == "expect") {
+            Expectation expectation;
+            expectation.line = lineNo;
+            if (!(words >> expectation.metric >> expectation.op >> expectation.value)) {
+                error = where + "expected 'expect <metric> <op> <number>'";
+                return false;
+            }
+            expectations.push_back(expectation);
+        } else if (key == "ap") {
+            hal::AccessPoint ap;
+            if (!(words >> ap.ssid >> ap.channel >> ap.rssi)) {
+                error = where + "expected 'ap <ssid> <channel> <rssi>'";
+                return false;
+            }
+            base.wifi.aps.push_back(ap);
+        } else if (key == "temp.trace") {
+            std::string traceFile;
+            words >> traceFile;
+            if (!loadTrace(directoryOf(file) + traceFile, trace, error)) return false;
+        } else {
+            auto it = setters().find(key);
+            double value;
+            if (it == setters().end()) {
+                error = where + "unknown setting '" + key + "'";
+                return false;
+            }
+            if (!(words >> value)) {
+                error = where + "'" + key + "' needs a number";
+                return false;
+            }
+            it->second(*this, value);
+        }
+    }
+
+    // No 'ap' lines: the first configured network, in range
+    if (base.wifi.aps.empty()) {
+        struct { const char* ssid; const char* pass; } networks[] = WIFI_NETWORKS;
+        hal::AccessPoint ap;
+        ap.ssid = networks[0].ssid;
+        base.wifi.aps.push_back(ap);
+    }
+    return true;
+}
+
+float Scenario::temperatureAt(uint64_t atUs) const {
+    if (!trace.empty()) {
+        if (atUs <= trace.front().atUs) return trace.front().tempC;
+        for (size_t i = 1; i < trace.size(); i++) {
+            if (atUs <= trace[i].atUs) {
+                const TracePoint& a = trace[i - 1];
+                const TracePoint& b = trace[i];
+                double f = (double)(atUs - a.atUs) / (double)(b.atUs - a.atUs);
+                return (float)(a.tempC + f * (b.tempC - a.tempC));
+            }
+        }
+        return trace.back().tempC;
+    }
+    // Local time of day from the scenario's start epoch, coolest at 03:00
+    double seconds = (double)startEpoch + (double)atUs / 1e6;
+    double dayFraction = fmod(seconds, 86400.0) / 86400.0;
+    return tempBase + tempSwing * (float)sin(2.0 * M_PI * (dayFraction - 0.375));
+}
+
+void Scenario::apply(uint64_t atUs, hal::Environment& env) const {
+    hal::Infrastructure* infrastructure = env.infrastructure;
+    env = base;
+    env.infrastructure = infrastructure;
+    env.sensor.tempC = temperatureAt(atUs);
+    for (const Event& e : events) {
+        if (atUs >= e.startUs && atUs < e.endUs) applyCondition(e.kind, e.value, env);
+    }
+}
+
+void Scenario::rollFaults(std::mt19937& rng, hal::Environment& env) const {
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (const Fault& f : faults) {
+        // Always draw, so one fault's outcome doesn't shift the others' sequence
+        if (unit(rng) < f.probability) applyCondition(f.kind, f.value, env);
+    }
+}
+
+bool Scenario::powerCycleBetween(uint64_t fromUs, uint64_t toUs) const {
+    for (const Event& e : events) {
+        if (e.kind == "power_cycle" && e.startUs > fromUs && e.startUs <= toUs) return true;
+    }
+    return false;
+}
+
+} // namespace sim
@@ -0,0 +1,98 @@
+#pragma once
+
+// ============================================
+// Scenario - a scripted environment for the simulator
+// Plain text, one setting per line:
+//
+//   days            7
+//   wifi.scan_ms    2200
+//   ap HomeNetwork 6 -58
+//   temp.swing      3.0
+//   at 2d for 6h    wifi_down
+//   at 3d for 1h    server_slow 12000
+//   fault sensor_disconnected 0.05
+//   expect lost == 0
+// ============================================
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "hal.h"
+
+namespace sim {
+
+struct Event {
+    uint64_t    startUs = 0;
+    uint64_t    endUs   = 0;
+    std::string kind;
+    long        value   = 0;
+};
+
+// Applies to a whole wake with the given probability, rolled per wake
+struct Fault {
+    std::string kind;
+    double      probability = 0;
+    long        value       = 0;
+};
+
+// A bound on one of the fault harness metrics
+struct Expectation {
+    std::string metric;
+    std::string op;         // <, <=, ==, >=, >
+    double      value = 0;
+    int         line  = 0;
+};
+
+struct TracePoint {
+    uint64_t atUs;
+    float    tempC;
+};
+
+// Fleet runs only: many devices sharing one AP and one ingest server
+struct FleetModel {
+    int      devices          = 200;
+    double   intervalS        = 0;      // 0: the firmware's own sleep request
+    double   phaseSpreadS     = 60;     // first wakes uniform over this window, 0 = aligned
+    double   rtcDriftPpm      = 0;      // per-device sleep timer error, uniform +/-
+    int      apMaxClients     = 64;     // associated stations the AP accepts
+    double   apAssocPenalty   = 0.15;   // connect time added per concurrent association
+    int      ingestWorkers    = 4;
+    uint32_t ingestServiceMs  = 30;
+    int      ingestQueueLimit = 128;    // waiting requests before 503
+};
+
+struct Scenario {
+    std::string      path;
+    uint32_t         seed          = 1;
+    double           days          = 1.0;
+    double           batteryMah    = 2500.0;
+    double           batteryUsable = 0.85;   // capacity left above brownout, after self-discharge
+    int64_t          startEpoch    = 1771322400;  // 2026-02-17T10:00:00Z
+    hal::Environment base;
+    float            tempBase      = 21.0f;
+    float            tempSwing     = 0.0f;   // daily sine amplitude, peak at 15:00
+    std::vector<TracePoint> trace;           // overrides base/swing when present
+    std::vector<Event>      events;
+    std::vector<Fault>      faults;
+    std::vector<Expectation> expectations;
+    FleetModel       fleet;
+
+    bool load(const std::string& file, std::string& error);
+
+    uint64_t durationUs() const { return (uint64_t)(days * 86400.0 * 1e6); }
+
+    // Environment at a point in time: base settings plus active events
+    void  apply(uint64_t atUs, hal::Environment& env) const;
+    // Roll the probabilistic faults for the next wake on top of apply()
+    void  rollFaults(std::mt19937& rng, hal::Environment& env) const;
+    float temperatureAt(uint64_t atUs) const;
+
+    // A power_cycle event starts in (fromUs, toUs]
+    bool  powerCycleBetween(uint64_t fromUs, uint64_t toUs) const;
+};
+
+// "90", "90s", "15m", "6h", "2d" -> microseconds
+bool parseDuration(const std::string& text, uint64_t& us);
+
+} // namespace sim
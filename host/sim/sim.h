@@ -0,0 +1,46 @@
+#pragma once
+
+// ============================================
+// Simulator commands and shared helpers
+// ============================================
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "hal.h"
+#include "scenario.h"
+
+// Firmware entry point from src/main.cpp
+void setup();
+
+// Readings the selected device holds in RTC memory for its next upload
+// (src/wake.cpp)
+uint8_t heldCount();
+
+namespace sim {
+
+// Run one wake of the firmware on a device: boot, setup() until deep
+// sleep, then the requested sleep - or sleepOverrideUs when non-zero -
+// stretched by sleepScale (RTC oscillator error). Returns false if
+// setup() returned without going to sleep. A power cut (hal::PowerCut)
+// ends the wake early and makes the next one a cold boot.
+bool runWake(hal::Device& device, uint64_t sleepOverrideUs = 0, double sleepScale = 1.0);
+
+// Run one device from power-on through the whole scenario, applying
+// events and rolled faults before each wake. afterWake sees every wake.
+bool runScenario(const Scenario& scenario, hal::Device& device,
+                 const std::function<void(hal::Device&)>& afterWake = nullptr);
+
+// p in [0, 100] over an unsorted sample
+uint32_t percentile(std::vector<uint32_t> values, double p);
+
+int energyCommand(int argc, char** argv);
+int fleetCommand(int argc, char** argv);
+int faultsCommand(int argc, char** argv);
+int benchCommand(int argc, char** argv);
+int exportCommand(int argc, char** argv);
+int backfillCommand(int argc, char** argv);
+int ingestCommand(int argc, char** argv);
+int powercutCommand(int argc, char** argv);
+
+} // namespace sim
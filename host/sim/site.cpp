@@ -0,0 +1,87 @@
+#include "site.h"
+
+#include <algorithm>
+
+namespace sim {
+
+// Intervals that can still overlap a new event: wakes start in order, so
+// nothing that ended this long before the current one matters any more.
+static const uint64_t HORIZON_US = 300ULL * 1000000ULL;
+
+Site::Site(const FleetModel& model) : model_(model), workerFreeUs_(model.ingestWorkers > 0 ? model.ingestWorkers : 1, 0) {}
+
+int Site::openAt(const std::vector<Interval>& intervals, uint64_t atUs) const {
+    int open = 0;
+    for (auto it = intervals.rbegin(); it != intervals.rend(); ++it) {
+        if (atUs > HORIZON_US && it->startUs < atUs - HORIZON_US) break;
+        if (it->startUs <= atUs && atUs < it->endUs) open++;
+    }
+    return open;
+}
+
+bool Site::associate(uint64_t atUs, uint32_t& connectMs) {
+    if (openAt(stations, atUs) >= model_.apMaxClients) {
+        refusedAssociations++;
+        return false;
+    }
+    // Handshakes compete for airtime with the ones already in progress
+    int contenders = openAt(associating, atUs);
+    connectMs = (uint32_t)(connectMs * (1.0 + model_.apAssocPenalty * contenders));
+    associating.push_back({ atUs, atUs + (uint64_t)connectMs * 1000ULL });
+
+    open_[&hal::device()] = stations.size();
+    stations.push_back({ atUs, UINT64_MAX });
+    return true;
+}
+
+void Site::disassociate(uint64_t atUs) {
+    auto it = open_.find(&hal::device());
+    if (it == open_.end()) return;
+    stations[it->second].endUs = atUs;
+    open_.erase(it);
+}
+
+// Multi-worker FIFO: a request waits for the earliest free worker
+void Site::serve(uint64_t atUs, size_t, int& status, uint32_t& latency) {
+    queuedStartUs_.erase(std::remove_if(queuedStartUs_.begin(), queuedStartUs_.end(),
+        [atUs](uint64_t startUs) { return startUs <= atUs; }), queuedStartUs_.end());
+    arrivalsUs.push_back(atUs);
+
+    uint64_t serviceUs = (uint64_t)model_.ingestServiceMs * 1000ULL;
+    if ((int)queuedStartUs_.size() >= model_.ingestQueueLimit) {
+        rejected++;
+        status = 503;
+        serviceUs = 1000;
+    } else {
+        auto worker = std::min_element(workerFreeUs_.begin(), workerFreeUs_.end());
+        uint64_t startUs = std::max(atUs, *worker);
+        if (startUs > atUs) queuedStartUs_.push_back(startUs);
+        peakQueue = std::max(peakQueue, (int)queuedStartUs_.size());
+        *worker = startUs + serviceUs;
+        serviceUs += startUs - atUs;
+    }
+
+    latency += (uint32_t)(serviceUs / 1000ULL);
+    latencyMs.push_back(latency);
+    inFlight.push_back({ atUs, atUs + (uint64_t)latency * 1000ULL });
+}
+
+int Site::peakOverlap(const std::vector<Interval>& intervals) {
+    std::vector<std::pair<uint64_t, int>> edges;
+    edges.reserve(intervals.size() * 2);
+    for (const Interval& i : intervals) {
+        edges.push_back({ i.startUs, 1 });
+        edges.push_back({ i.endUs, -1 });
+    }
+    // Ends sort before starts at the same instant
+    std::sort(edges.begin(), edges.end());
+    int open = 0;
+    int peak = 0;
+    for (const auto& edge : edges) {
+        open += edge.second;
+        peak = std::max(peak, open);
+    }
+    return peak;
+}
+
+} // namespace sim
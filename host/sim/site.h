@@ -0,0 +1,52 @@
+#pragma once
+
+// ============================================
+// Site - the AP and ingest server a fleet shares
+// An in-process stand-in driven by virtual time. Devices run one wake at a
+// time in wake-start order, so every interval is recorded and overlap is
+// counted against the intervals of wakes that already ran.
+// ============================================
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "hal.h"
+#include "scenario.h"
+
+namespace sim {
+
+struct Interval {
+    uint64_t startUs;
+    uint64_t endUs;
+};
+
+class Site : public hal::Infrastructure {
+public:
+    explicit Site(const FleetModel& model);
+
+    bool associate(uint64_t atUs, uint32_t& connectMs) override;
+    void disassociate(uint64_t atUs) override;
+    void serve(uint64_t atUs, size_t bytes, int& status, uint32_t& latencyMs) override;
+
+    // Largest number of intervals open at the same instant
+    static int peakOverlap(const std::vector<Interval>& intervals);
+
+    std::vector<Interval> stations;      // association -> disassociation
+    std::vector<Interval> associating;   // association handshakes
+    std::vector<Interval> inFlight;      // request arrival -> response
+    std::vector<uint64_t> arrivalsUs;
+    std::vector<uint32_t> latencyMs;     // as seen by the device
+    int refusedAssociations = 0;
+    int rejected            = 0;         // 503 from a full queue
+    int peakQueue           = 0;
+
+private:
+    int  openAt(const std::vector<Interval>& intervals, uint64_t atUs) const;
+
+    FleetModel model_;
+    std::vector<uint64_t> workerFreeUs_;
+    std::vector<uint64_t> queuedStartUs_;           // accepted requests not yet started
+    std::map<const hal::Device*, size_t> open_;     // device -> open entry in stations
+};
+
+} // namespace sim
@@ -0,0 +1,62 @@
+#include "sim.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <random>
+
+namespace sim {
+
+bool runWake(hal::Device& device, uint64_t sleepOverrideUs, double sleepScale) {
+    hal::select(device);
+    hal::beginWake();
+
+    bool slept = false;
+    try {
+        setup();
+    } catch (const hal::DeepSleep&) {
+        slept = true;
+    } catch (const hal::PowerCut&) {
+        // Brownout mid-wake: the next wake is a cold boot with RTC memory lost
+        hal::endWake();
+        hal::powerCycle(device.epochBase + (int64_t)(device.clockUs / 1000000ULL));
+        return true;
+    }
+    hal::endWake();
+
+    if (!slept) {
+        fprintf(stderr, "setup() returned without entering deep sleep\n");
+        return false;
+    }
+    uint64_t sleepUs = sleepOverrideUs ? sleepOverrideUs : device.sleepUs;
+    hal::sleepFor((uint64_t)((double)sleepUs * sleepScale));
+    return true;
+}
+
+bool runScenario(const Scenario& scenario, hal::Device& device,
+                 const std::function<void(hal::Device&)>& afterWake) {
+    hal::select(device);
+    hal::powerCycle(scenario.startEpoch);
+
+    std::mt19937 rng(scenario.seed);
+    uint64_t previousUs = 0;
+    while (device.clockUs < scenario.durationUs()) {
+        if (scenario.powerCycleBetween(previousUs, device.clockUs)) {
+            hal::powerCycle(scenario.startEpoch + (int64_t)(device.clockUs / 1000000ULL));
+        }
+        previousUs = device.clockUs;
+        scenario.apply(device.clockUs, hal::env());
+        scenario.rollFaults(rng, hal::env());
+        if (!runWake(device)) return false;
+        if (afterWake) afterWake(device);
+    }
+    return true;
+}
+
+uint32_t percentile(std::vector<uint32_t> values, double p) {
+    if (values.empty()) return 0;
+    size_t rank = (size_t)(p / 100.0 * (double)(values.size() - 1) + 0.5);
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+} // namespace sim
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================
+// Access point history
+// One record per network in WIFI_NETWORKS, in RTC memory: how often it
+// was joined, and its RSSI and channel the last time. A wake probes the
+// likeliest networks on their last channels - one channel each, a tenth
+// of a full scan - before falling back to a scan of all of them.
+// Lost with RTC memory on a power cut; the first wake after one scans.
+//
+// The same history sets the TX power for a join. The AP hears us about
+// as well as we hear it, so while the weakest recent RSSI from a network
+// stays above WIFI_TX_RSSI_TARGET_DBM the surplus comes off the TX power.
+// A failed probe or a join that took retries puts that network back on
+// full power, and the margin then comes back by 1 dB every
+// WIFI_TX_RECOVER_JOINS joins.
+// ============================================
+#define AP_HISTORY_MAX 16
+
+// Quarter-dBm, as esp_wifi_set_max_tx_power() and wifi_power_t take it
+#define AP_TX_POWER_MAX 78  // 19.5 dBm, the driver's default
+
+struct ApRecord {
+    uint16_t joins;         // saturating
+    uint8_t  channel;       // 0: never joined
+    int8_t   rssi;          // dBm, last join
+    int8_t   rssiFloor;     // dBm, lowest recent join; never above rssi
+    uint8_t  floorAge;      // joins since rssiFloor last moved
+};
+
+// Up to max indexes into WIFI_NETWORKS worth a probe, likeliest first:
+// the network joined last, then by joins. Only networks with a known
+// channel. Returns how many.
+uint8_t apProbeOrder(uint8_t networks, uint8_t* order, uint8_t max);
+
+void            apJoined(uint8_t index, uint8_t channel, int8_t rssi);
+const ApRecord& apRecord(uint8_t index);
+
+// TX power to join this network with, quarter-dBm
+int8_t apTxPower(uint8_t index);
+
+// A probe of this network failed, it took retries, or the link dropped
+// the upload: full power again
+void apTxFailed(uint8_t index);
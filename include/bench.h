@@ -0,0 +1,26 @@
+#pragma once
+
+// ============================================
+// Microbenchmarks for the per-wake CPU hot paths
+// Built with -DBENCH_HARNESS: env:native ("program bench") and the
+// *_bench target envs ("bench" in the serial console, src/console.cpp).
+// ============================================
+#ifdef BENCH_HARNESS
+
+#include <stddef.h>
+
+struct BenchResult {
+    const char* name;
+    double      nsPerOp;
+    double      allocsPerOp;
+};
+
+typedef void (*BenchEmit)(const BenchResult& result);
+
+// Run every stage and report it; one line per stage in formatBenchLine()
+void runBenchmarks(BenchEmit emit);
+
+// "bench json_payload 1234.5 ns/op 3.00 allocs/op"
+void formatBenchLine(const BenchResult& result, char* buf, size_t size);
+
+#endif // BENCH_HARNESS
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================
+// Server circuit breaker
+// In RTC memory, apart from the WiFi side (include/ap_history.h): the
+// link can be fine while the server is down, and a wake that joins WiFi
+// still needs it for NTP and the AP history. What the breaker saves is
+// the TLS handshake and the request, up to HTTP_TIMEOUT_MS of radio.
+//
+// Closed, every upload goes out. SERVER_BREAKER_TRIP server failures in
+// a row open it: uploads are skipped and the readings stay in the CSV.
+// After a backoff, counted in skipped uploads, it is half-open: the next
+// upload goes out as a probe. Success closes it; failure opens it again
+// with the backoff doubled, up to SERVER_BREAKER_BACKOFF_MAX. A power cut
+// loses RTC memory and closes it.
+// ============================================
+enum BreakerState : uint8_t {
+    BREAKER_CLOSED,
+    BREAKER_OPEN,
+    BREAKER_HALF_OPEN
+};
+
+// Once per wake that would upload, with the link up. False: skip the
+// upload. An open breaker whose backoff is over turns half-open and
+// allows this one.
+bool breakerAllows();
+
+// What became of an upload that went out. Only a server failure counts -
+// no answer, a timeout, 5xx - not a link lost on the way.
+void breakerServerOk();
+void breakerServerFailed();
+
+BreakerState breakerState();
+uint8_t      breakerBackoff();   // skipped uploads per open spell
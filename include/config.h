@@ -21,12 +21,61 @@
 // ============================================
 // Sensor Configuration
 // ============================================
+// Sensor driver (include/sensor.h), fixed at build time:
+// e.g. -DSENSOR_TYPE=SENSOR_SHT3X
+#define SENSOR_DS18B20  1
+#define SENSOR_SHT3X    2
+#define SENSOR_BME280   3
+#ifndef SENSOR_TYPE
+#define SENSOR_TYPE     SENSOR_DS18B20
+#endif
+
 // GPIO pin connected to DS18B20 data line
 // Requires 4.7kΩ pull-up resistor to 3.3V
 #ifndef ONE_WIRE_PIN
 #define ONE_WIRE_PIN    4
 #endif
 
+// Pins of every OneWire bus, one DS18B20 channel each, in channel order.
+// All buses convert at once, so more buses don't lengthen the wake. Each
+// needs its own pull-up. e.g. -D'ONE_WIRE_PINS={4,5,18}', up to 8
+#ifndef ONE_WIRE_PINS
+#define ONE_WIRE_PINS   { ONE_WIRE_PIN }
+#endif
+
+// I2C sensors (SHT3x, BME280): bus pins, and the address of each sensor in
+// channel order, e.g. -D'SENSOR_I2C_ADDRESSES={0x44,0x45}'. Both parts
+// pull SDA/SCL up on the usual breakout boards.
+#ifndef I2C_SDA_PIN
+#define I2C_SDA_PIN     21
+#endif
+#ifndef I2C_SCL_PIN
+#define I2C_SCL_PIN     22
+#endif
+#ifndef SENSOR_I2C_ADDRESSES
+#if SENSOR_TYPE == SENSOR_BME280
+#define SENSOR_I2C_ADDRESSES { 0x76 }
+#else
+#define SENSOR_I2C_ADDRESSES { 0x44 }
+#endif
+#endif
+
+// Conversions per reading. 1: one full-resolution conversion (DS18B20:
+// 750 ms after a discarded one). More: that many SENSOR_SAMPLE_BITS
+// conversions back to back, median/MAD filtered (include/oversample.h),
+// up to 15
+#ifndef SENSOR_SAMPLES
+#define SENSOR_SAMPLES          1
+#endif
+
+// Resolution of each oversampled conversion: 9 bits = 0.5 °C in 94 ms,
+// 10 = 0.25 °C in 188 ms, 11 = 0.125 °C in 375 ms on a DS18B20; the I2C
+// drivers map it to their faster modes. The mean of several resolves
+// finer than one step only when the noise spans a step.
+#ifndef SENSOR_SAMPLE_BITS
+#define SENSOR_SAMPLE_BITS      9
+#endif
+
 // ============================================
 // Timing Configuration
 // ============================================
@@ -34,8 +83,97 @@
 #define WIFI_TIMEOUT_MS         20000   // 20 seconds to connect
 #define HTTP_TIMEOUT_MS         10000   // 10 seconds for HTTP request
 
+// Server circuit breaker (include/breaker.h): uploads are skipped after
+// SERVER_BREAKER_TRIP server failures in a row, for a backoff counted in
+// uploads that doubles after every failed probe
+#define SERVER_BREAKER_TRIP         3
+#define SERVER_BREAKER_BACKOFF_MIN  2
+#define SERVER_BREAKER_BACKOFF_MAX  32
+
+// Networks tried on the channel they were last joined on before a full
+// scan (include/ap_history.h), and how long each such probe may take
+#ifndef WIFI_PROBE_CANDIDATES
+#define WIFI_PROBE_CANDIDATES   2
+#endif
+#define WIFI_PROBE_TIMEOUT_MS   3000
+
+// TX power from each network's RSSI history (include/ap_history.h): the
+// link margin above the target comes off the TX power; a failure puts
+// that network back on full power, and the margin returns 1 dB per
+// WIFI_TX_RECOVER_JOINS joins
+#ifndef WIFI_TX_ADAPTIVE
+#define WIFI_TX_ADAPTIVE        1
+#endif
+#define WIFI_TX_RSSI_TARGET_DBM -67
+#define WIFI_TX_RECOVER_JOINS   4
+
 // NTP re-sync interval - no need to sync every wake cycle
 #define NTP_SYNC_INTERVAL_BOOTS 20      // Re-sync NTP every N wake cycles
+#define NTP_TIMEOUT_MS          5000    // then the wake goes on without it
+
+// Readings per upload. 1: every wake uploads its reading. More: the wakes
+// in between only read the sensor into RTC memory (include/wake.h), and
+// every Nth wake stores and uploads them all as one JSON array. A power
+// cut loses what is held. Up to 32.
+#ifndef UPLOAD_EVERY_N_READINGS
+#define UPLOAD_EVERY_N_READINGS 1
+#endif
+
+// ============================================
+// Logging (include/log.h)
+// ============================================
+// Least severe level built in: LOG_LEVEL_NONE, _ERROR, _WARN, _INFO, _DEBUG
+#ifndef LOG_LEVEL
+#define LOG_LEVEL               LOG_LEVEL_DEBUG
+#endif
+
+// ============================================
+// Serial and console (src/console.cpp)
+// ============================================
+// 0 compiles out the serial port, every print and the console
+#ifndef SERIAL_OUTPUT
+#define SERIAL_OUTPUT           1
+#endif
+
+// Wait after Serial.begin() on wakes that bring the port up, so a monitor
+// sees the banner; timer wakes without a host skip port and wait
+#ifndef SERIAL_SETTLE_MS
+#define SERIAL_SETTLE_MS        500
+#endif
+
+// How long the console listens after a cold boot or with a USB host attached
+#ifndef CONSOLE_WINDOW_MS
+#define CONSOLE_WINDOW_MS       3000
+#endif
+
+// ============================================
+// Diagnostics
+// ============================================
+// Attach the diagnostics record (include/diagnostics.h) to every Nth
+// upload attempt; 0 turns it off
+#ifndef DIAGNOSTICS_EVERY_N_UPLOADS
+#define DIAGNOSTICS_EVERY_N_UPLOADS 1
+#endif
+
+// ============================================
+// Flash
+// ============================================
+// Rated erase cycles per sector of the SPI flash (datasheet minimum)
+#ifndef FLASH_ENDURANCE_CYCLES
+#define FLASH_ENDURANCE_CYCLES  100000
+#endif
+
+// Bytes of the data file per time index entry (src/storage.cpp): an
+// 8-byte entry per flash block of readings
+#ifndef DATA_INDEX_STRIDE
+#define DATA_INDEX_STRIDE       4096
+#endif
+
+// Bytes at the end of the data file that recovery checks after a reset
+// other than a timer wake; a torn append is far shorter than this
+#ifndef DATA_RECOVERY_WINDOW
+#define DATA_RECOVERY_WINDOW    4096
+#endif
 
 // ============================================
 // Status LED
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+
+// ============================================
+// Serial policy
+// Bringing up the port, waiting for the monitor and printing the banner
+// cost half a second of active current per wake. Only wakes where someone
+// may be listening get them: cold boots (power-on, reset button, brownout)
+// and wakes with a USB CDC host on the port. SERIAL_OUTPUT 0 compiles the
+// port, every print and the console out of the firmware.
+// ============================================
+// First thing in setup(): decides for this wake, true if Serial is up
+bool serialBegin();
+
+// Serial was brought up this wake
+bool serialUp();
+
+// Prints that cost nothing on a wake without Serial - the arguments are
+// not even evaluated - and vanish from a SERIAL_OUTPUT 0 build
+#if SERIAL_OUTPUT
+#define SERIAL_PRINT(...)   do { if (serialUp()) Serial.print(__VA_ARGS__); } while (0)
+#define SERIAL_PRINTLN(...) do { if (serialUp()) Serial.println(__VA_ARGS__); } while (0)
+#define SERIAL_PRINTF(...)  do { if (serialUp()) Serial.printf(__VA_ARGS__); } while (0)
+#define SERIAL_FLUSH()      do { if (serialUp()) Serial.flush(); } while (0)
+#else
+#define SERIAL_PRINT(...)   do {} while (0)
+#define SERIAL_PRINTLN(...) do {} while (0)
+#define SERIAL_PRINTF(...)  do {} while (0)
+#define SERIAL_FLUSH()      do {} while (0)
+#endif
+
+// ============================================
+// Serial command console
+// Open for CONSOLE_WINDOW_MS after a cold boot (power-on, reset button)
+// or on any wake while a USB CDC host has the port open; each command
+// restarts the window. Timer wakes without a host skip it entirely.
+//
+//   stats                   counters, file sizes, flash wear
+//   tail log N              last N lines of the log
+//   export since <epoch> [until <epoch>]
+//                           CSV rows in a Unix time range (since 0: all)
+//   clear backlog           delete the local CSV after an export
+//   bench                   microbenchmarks (BENCH_HARNESS builds)
+//   exit                    close the console and carry on with the wake
+//
+// Every response is framed so a script can check it arrived intact:
+//
+//   #BEGIN <command>
+//   <body lines>
+//   #END <body lines> <CRC-32 of the body bytes, 8 hex digits>
+//
+// or "#ERR <message>" for a bad command.
+// ============================================
+
+// Blocks until the window closes or "exit"; returns at once on a wake
+// without Serial
+void consoleRun(int bootCount);
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================
+// Per-wake diagnostics carried on uploads
+// Gathered into static storage (no heap) and sent as the "diag" field of
+// the JSON payload: base64 of a fixed 33-byte little-endian record.
+//
+//   off size field
+//     0   1  layout version (2)
+//     1   1  reset reason (esp_reset_reason_t)
+//     2   2  ms since setup() started, when the payload was built
+//     4   2  previous wake, setup() to deep sleep, ms
+//     6  12  phase ms: init, wifi, ntp, sensor, store, upload (upload is
+//            from the previous wake - this one hasn't finished it yet)
+//    18   1  RSSI, dBm (int8)
+//    19   1  connect attempts: channel probes and full scans
+//    20   1  index into WIFI_NETWORKS of the AP joined (int8, -1 none)
+//    21   1  flags: bit 0 NTP time valid, bit 1 previous upload failed,
+//            bit 2 probe of a half-open server circuit breaker
+//    22   4  minimum free heap since boot, bytes
+//    26   2  LittleFS free, KB
+//    28   2  consecutive failed uploads before this one
+//    30   2  readings not delivered to the server since power-on
+//    32   1  TX power the AP was joined with, quarter-dBm (int8, 0 none)
+//
+// 16-bit fields saturate at 65535.
+// ============================================
+#define DIAG_VERSION       2
+#define DIAG_RECORD_BYTES  33
+
+enum DiagPhase : uint8_t {
+    PHASE_INIT,
+    PHASE_WIFI,
+    PHASE_NTP,
+    PHASE_SENSOR,
+    PHASE_STORE,
+    PHASE_UPLOAD,
+    PHASE_COUNT
+};
+
+// Call once per wake, as early in setup() as possible
+void diagBeginWake();
+
+// Ends the running phase and starts the next one
+void diagPhase(DiagPhase phase);
+
+void diagWifi(int8_t rssi, uint8_t attempts, int8_t apIndex, int8_t txPower);
+void diagReadingUndelivered();
+void diagUploadResult(bool ok);
+
+uint16_t diagFailedUploads();
+uint16_t diagUndeliveredReadings();
+void     diagClearUndelivered();
+
+// Saves what the next wake reports about this one; call before deep sleep
+void diagEndWake();
+
+// Base64 of the record for this upload, or nullptr when this upload
+// shouldn't carry one (see DIAGNOSTICS_EVERY_N_UPLOADS). Points to static
+// storage valid until the next call.
+const char* diagForUpload();
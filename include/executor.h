@@ -0,0 +1,85 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include "diagnostics.h"
+
+// ============================================
+// Wake executor
+// The steps of a full wake - sensor, connect, sync, store, upload - run
+// as tasks on one thread, so the sensor converts while the radio works
+// and no step can hold the wake past its budget. No task has a stack of
+// its own: a task is a state machine whose resume() does what it can
+// without blocking and returns.
+//
+// When no task can go on, run() waits on an event group: driver events
+// (WiFi, SNTP) set its bits and end the wait at once, and the wait never
+// outlasts the soonest time a task asked to be resumed at.
+//
+// A task starts once the tasks it runs after have finished, however they
+// finished; it looks at how itself. A task still running budgetMs after
+// it started is cancelled: cancel() lets go of what it holds (a join in
+// progress, a socket) and it finishes as TASK_CANCELLED.
+// ============================================
+#define EXECUTOR_MAX_TASKS  8
+#define TASK_MAX_AFTER      3
+
+// Event group bits the executor wakes on; the rest are not for tasks
+#define EXECUTOR_EVENT_BITS 0x00FFFFFF
+
+enum TaskState : uint8_t {
+    TASK_WAITING,       // for the tasks it runs after
+    TASK_RUNNING,
+    TASK_DONE,
+    TASK_FAILED,
+    TASK_CANCELLED      // out of budget
+};
+
+class Task {
+public:
+    explicit Task(DiagPhase phase, uint32_t budgetMs = UINT32_MAX) : phase(phase), budgetMs(budgetMs) {}
+
+    // Called on every pass while running; events are the bits set since
+    // the last pass. Returns TASK_RUNNING, TASK_DONE or TASK_FAILED. To be
+    // resumed by a time rather than an event, set resumeAtMs.
+    virtual TaskState resume(uint32_t nowMs, EventBits_t events) = 0;
+    virtual void      cancel() {}
+
+    // Starts once every task here has finished (up to TASK_MAX_AFTER)
+    void runAfter(Task& task);
+
+    bool finished() const { return state >= TASK_DONE; }
+    bool done() const     { return state == TASK_DONE; }
+    uint32_t remainingMs(uint32_t nowMs) const;
+
+    const DiagPhase phase;      // where its time goes in the diagnostics
+    const uint32_t  budgetMs;
+    TaskState state      = TASK_WAITING;
+    uint32_t  startedMs  = 0;
+    uint32_t  resumeAtMs = UINT32_MAX;
+
+private:
+    friend class Executor;
+    Task*   after_[TASK_MAX_AFTER] = {};
+    uint8_t afterCount_ = 0;
+};
+
+class Executor {
+public:
+    explicit Executor(EventGroupHandle_t events) : events_(events) {}
+
+    // In order of precedence: a pass resumes tasks in this order, and time
+    // spent waiting goes to the phase of the first one running
+    void add(Task& task);
+
+    // Returns once every task has finished
+    void run();
+
+private:
+    bool ready(const Task& task) const;
+
+    EventGroupHandle_t events_;
+    Task*   tasks_[EXECUTOR_MAX_TASKS];
+    uint8_t count_ = 0;
+};
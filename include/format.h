@@ -0,0 +1,40 @@
+#pragma once
+
+#include <Arduino.h>
+#include <time.h>
+#include "temperature.h"
+
+// ============================================
+// Text formats for the log, the local CSV and the upload payload
+// Pure CPU work on every wake - benchmarked in src/bench.cpp
+// ============================================
+
+// "2026-02-17T10:00:02"
+String formatIsoTime(const struct tm& timeinfo);
+
+// "[2026-02-17T10:00:02] message"
+String formatLogLine(const String& timestamp, const String& message);
+
+// Temperatures are centi-degrees (temperature.h), printed with integer
+// arithmetic only
+
+// Longest formatCenti() text plus its terminator: "-21474836.48"
+#define TEMP_TEXT_BYTES 16
+
+// "22.56", "-0.06"; returns the length
+size_t formatCenti(int32_t centi, char* out);
+
+// "timestamp,temperature_celsius" - more channels add
+// ",temperature_celsius_2" and so on
+String formatCsvHeader(uint8_t channels);
+
+// "2026-02-17T10:00:02,22.56"; more channels add columns, left empty for
+// a channel that failed ("...,22.56,,19.12")
+String formatCsvRow(const String& timestamp, const TempRecord& record);
+
+// {"temperature":22.56,"unit":"celsius","timestamp":"...","device":"...","diag":"...","spread":0.03}
+// "temperature" is channel 1; with more channels "channels" lists them
+// all, null where one failed. "diag" only when diag is not null (see
+// diagnostics.h), "spread" ("spreads" per channel) only for oversampled
+// readings.
+String buildPayload(const TempRecord& record, const String& timestamp, const char* diag = nullptr);
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+
+// ============================================
+// Log levels, filtered at compile time
+// A message below LOG_LEVEL is not built, formatted or written: the macro
+// expands to nothing, arguments included. Development builds keep
+// everything; production builds (platformio.ini) keep warnings and errors,
+// which also keeps routine wakes from writing to the log file.
+// ============================================
+#define LOG_LEVEL_NONE   0
+#define LOG_LEVEL_ERROR  1
+#define LOG_LEVEL_WARN   2
+#define LOG_LEVEL_INFO   3
+#define LOG_LEVEL_DEBUG  4
+
+// Timestamped line to Serial (when up) and LOG_FILE - src/main.cpp
+void logMessage(const String& message);
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(message) logMessage(message)
+#else
+#define LOG_ERROR(message) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(message)  logMessage(message)
+#else
+#define LOG_WARN(message)  do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(message)  logMessage(message)
+#else
+#define LOG_INFO(message)  do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(message) logMessage(message)
+#else
+#define LOG_DEBUG(message) do {} while (0)
+#endif
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================
+// Robust filter for several short conversions of one sensor
+// Samples are raw sensor counts. The median and the median absolute
+// deviation (MAD) are found first; samples further than 3 MADs from the
+// median - never closer than one LSB, so a steady signal that toggles
+// between two adjacent counts keeps both - are dropped as glitches, and
+// the rest are averaged. Integer only; pure CPU work benchmarked in
+// src/bench.cpp.
+// ============================================
+#define OVERSAMPLE_MAX  15
+
+struct FilteredSamples {
+    int32_t sum;        // of the samples kept; divide by kept
+    uint8_t kept;
+    uint8_t rejected;   // outliers and failed reads
+    int32_t mad;        // median absolute deviation, raw counts
+};
+
+// Sorts samples in place. invalid marks a failed read, never kept.
+// False when fewer than half the samples are valid: no majority to
+// trust the median of.
+bool filterSamples(int32_t* samples, uint8_t count, int32_t lsb, int32_t invalid,
+                   FilteredSamples& out);
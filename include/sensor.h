@@ -0,0 +1,207 @@
+#pragma once
+
+#include <Arduino.h>
+#include "config.h"
+#include "format.h"
+#include "log.h"
+#include "oversample.h"
+#include "temperature.h"
+
+// ============================================
+// Sensor drivers, chosen at compile time (SENSOR_TYPE in config.h)
+// A driver runs one sensor on one channel. Sensors<Driver, N> below runs
+// N of them as one record and calls the driver directly - no virtuals,
+// no driver code linked in but the one selected. A driver provides:
+//
+//   static const char* name()             "DS18B20", for log lines
+//   WARMUP_CONVERSIONS                     thrown away before a single read
+//   POLL_MS                                interval between conversionDone() checks
+//   MIN_CENTI_C, MAX_CENTI_C               rated range; outside it is a fault
+//   bool     begin(uint8_t id)             find the sensor (id: GPIO pin or
+//                                          I2C address, from SENSOR_CHANNEL_IDS)
+//   void     configure(uint8_t bits)       9-12: trade resolution for speed,
+//                                          for the conversions that follow
+//   void     startConversion()             returns at once
+//   uint32_t readyMs()                     worst-case time to a result
+//   bool     conversionDone()              asks the sensor; cheap, one short
+//                                          bus transaction
+//   bool     readRaw(int32_t& raw)         false: no answer
+//   int32_t  lsb()                         raw counts per step
+//   static int32_t toCentiC(sum, count)    mean of count raw readings
+//
+// Raw readings must be linear in temperature: the oversampling filter
+// averages them before toCentiC().
+// ============================================
+#if SENSOR_TYPE == SENSOR_DS18B20
+#include "sensor_ds18b20.h"
+typedef Ds18b20 SensorDriver;
+#define SENSOR_CHANNEL_IDS  ONE_WIRE_PINS
+#elif SENSOR_TYPE == SENSOR_SHT3X
+#include "sensor_sht3x.h"
+typedef Sht3x SensorDriver;
+#define SENSOR_CHANNEL_IDS  SENSOR_I2C_ADDRESSES
+#elif SENSOR_TYPE == SENSOR_BME280
+#include "sensor_bme280.h"
+typedef Bme280 SensorDriver;
+#define SENSOR_CHANNEL_IDS  SENSOR_I2C_ADDRESSES
+#else
+#error "unknown SENSOR_TYPE"
+#endif
+
+// Marks a failed read among the samples
+#define SENSOR_NO_READING INT32_MIN
+
+// ============================================
+// One sensor per channel. Conversions start on every channel and run
+// together, so a reading costs one conversion time however many channels
+// there are. Values are centi-degrees C (temperature.h).
+//
+// read() on its own blocks for every conversion. To convert while doing
+// something else, start() first and call poll() between other steps:
+// each call collects a finished conversion and starts the next, without
+// waiting. read() then only waits for what is left.
+// ============================================
+template <typename Driver, uint8_t N>
+class Sensors {
+    static_assert(N >= 1 && N <= TEMP_MAX_CHANNELS, "1 to TEMP_MAX_CHANNELS sensor channels");
+
+public:
+    explicit Sensors(const uint8_t (&ids)[N]) : ids_(ids) {}
+
+    // False when no channel has a sensor
+    bool begin() {
+        bool any = false;
+        String missing;
+        for (uint8_t ch = 0; ch < N; ch++) {
+            found_[ch] = drivers_[ch].begin(ids_[ch]);
+            if (!found_[ch]) missing += " " + String(ch + 1);
+            any |= found_[ch];
+        }
+        // One line, not one per channel: before NTP every log line waits for the clock
+        if (any && missing.length()) LOG_ERROR(String("No ") + Driver::name() + " on channel" + missing);
+        return any;
+    }
+
+    // Starts the first conversion of the next reading
+    void start() {
+#if SENSOR_SAMPLES > 1
+        // Short conversions back to back; a stray power-on value is just
+        // another outlier for the filter, so nothing is discarded up front
+        for (uint8_t ch = 0; ch < N; ch++) {
+            if (found_[ch]) drivers_[ch].configure(SENSOR_SAMPLE_BITS);
+        }
+#endif
+        reading_ = true;
+        converted_ = 0;
+        startAll();
+    }
+
+    // Never waits. True once every conversion of the reading is in.
+    bool poll() {
+        if (!reading_) return false;
+        if (converted_ == CONVERSIONS) return true;
+        // Silicon usually beats the datasheet maximum, which only bounds
+        // the wait for a sensor that never says it is done
+        if (millis() - startedMs_ < waitMs_ && !allDone()) return false;
+
+        if (converted_ >= WARMUP) {
+            uint8_t i = converted_ - WARMUP;
+            for (uint8_t ch = 0; ch < N; ch++) {
+                int32_t raw;
+                samples_[ch][i] = found_[ch] && drivers_[ch].readRaw(raw) ? raw : SENSOR_NO_READING;
+            }
+        }
+        if (++converted_ < CONVERSIONS) startAll();
+        return converted_ == CONVERSIONS;
+    }
+
+    // False when every channel failed
+    bool read(TempRecord& record) {
+        if (!reading_) start();
+        while (!poll()) delay(Driver::POLL_MS);
+        reading_ = false;
+
+        bool any = false;
+        record.channels = N;
+        for (uint8_t ch = 0; ch < N; ch++) {
+            record.centiC[ch] = channelValue(ch, samples_[ch], record.spreadCenti[ch]);
+            any |= record.centiC[ch] != TEMP_INVALID;
+        }
+        return any;
+    }
+
+private:
+#if SENSOR_SAMPLES > 1
+    static const uint8_t WARMUP = 0;
+#else
+    // The DS18B20 returns 85°C (power-on default) on its first conversion
+    static const uint8_t WARMUP = Driver::WARMUP_CONVERSIONS;
+#endif
+    static const uint8_t CONVERSIONS = WARMUP + SENSOR_SAMPLES;
+
+    // Starts a conversion on every channel; the slowest bounds the wait
+    void startAll() {
+        waitMs_ = 0;
+        for (uint8_t ch = 0; ch < N; ch++) {
+            if (!found_[ch]) continue;
+            drivers_[ch].startConversion();
+            uint32_t readyMs = drivers_[ch].readyMs();
+            if (readyMs > waitMs_) waitMs_ = readyMs;
+        }
+        startedMs_ = millis();
+    }
+
+    bool allDone() {
+        for (uint8_t ch = 0; ch < N; ch++) {
+            if (found_[ch] && !drivers_[ch].conversionDone()) return false;
+        }
+        return true;
+    }
+
+    // Centi-degrees from one channel's samples, TEMP_INVALID on failure
+    int16_t channelValue(uint8_t ch, int32_t* samples, int16_t& spread) {
+        spread = TEMP_INVALID;
+#if SENSOR_SAMPLES > 1
+        FilteredSamples filtered;
+        if (!filterSamples(samples, SENSOR_SAMPLES, drivers_[ch].lsb(), SENSOR_NO_READING, filtered)) {
+            LOG_ERROR("Sensor error: device disconnected" + suffix(ch));
+            return TEMP_INVALID;
+        }
+        if (filtered.rejected) {
+            LOG_DEBUG("Sensor: rejected " + String(filtered.rejected) + " of " + String(SENSOR_SAMPLES) +
+                      " samples" + suffix(ch));
+        }
+        int32_t centiC = Driver::toCentiC(filtered.sum, filtered.kept);
+        // A difference of raw counts: scale without the zero offset
+        spread = (int16_t)(Driver::toCentiC(filtered.mad, 1) - Driver::toCentiC(0, 1));
+#else
+        if (samples[0] == SENSOR_NO_READING) {
+            LOG_ERROR("Sensor error: device disconnected" + suffix(ch));
+            return TEMP_INVALID;
+        }
+        int32_t centiC = Driver::toCentiC(samples[0], 1);
+#endif
+        if (centiC < Driver::MIN_CENTI_C || centiC > Driver::MAX_CENTI_C) {
+            char text[TEMP_TEXT_BYTES];
+            formatCenti(centiC, text);
+            LOG_ERROR("Sensor error: reading out of range: " + String(text) + suffix(ch));
+            spread = TEMP_INVALID;
+            return TEMP_INVALID;
+        }
+        return (int16_t)centiC;
+    }
+
+    // " on channel 2" - nothing with a single channel
+    static String suffix(uint8_t ch) {
+        return N > 1 ? " on channel " + String(ch + 1) : String("");
+    }
+
+    Driver         drivers_[N];
+    bool           found_[N] = {};
+    const uint8_t* ids_;
+    int32_t        samples_[N][SENSOR_SAMPLES];
+    bool           reading_   = false;  // start() called, read() not yet
+    uint8_t        converted_ = 0;      // conversions of this reading done
+    uint32_t       startedMs_ = 0;      // of the one in flight
+    uint32_t       waitMs_    = 0;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================
+// Bosch BME280 on I2C (SENSOR_TYPE SENSOR_BME280)
+// Channel id: the I2C address, 0x76 or 0x77 (SDO high). Forced mode, one
+// measurement per conversion, temperature only; raw readings are already
+// compensated centi-degrees (the datasheet's integer formula), so
+// toCentiC() only averages. 6 ms at x2 oversampling, 4 ms at x1, at
+// most; the status register says when it is done.
+// ============================================
+class Bme280 {
+public:
+    static const char* name() { return "BME280"; }
+    static const uint8_t WARMUP_CONVERSIONS = 0;
+    static const uint8_t POLL_MS = 1;
+    static const int16_t MIN_CENTI_C = -4000;
+    static const int16_t MAX_CENTI_C = 8500;
+
+    bool     begin(uint8_t address);
+    void     configure(uint8_t bits);
+    void     startConversion();
+    uint32_t readyMs() const;
+    bool     conversionDone();
+    bool     readRaw(int32_t& raw);
+    int32_t  lsb() const { return 1; }
+
+    static int32_t toCentiC(int32_t sum, uint32_t count);
+
+private:
+    bool readRegisters(uint8_t reg, uint8_t* out, uint8_t len);
+
+    uint8_t  address_ = 0x76;
+    uint8_t  oversampling_ = 2;      // osrs_t: 1 = x1, 2 = x2
+    uint16_t digT1_ = 0;             // temperature calibration, from NVM
+    int16_t  digT2_ = 0;
+    int16_t  digT3_ = 0;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <OneWire.h>
+#include <DallasTemperature.h>
+#include "temperature.h"
+
+// ============================================
+// DS18B20 on its own OneWire bus (SENSOR_TYPE SENSOR_DS18B20)
+// Channel id: the bus GPIO. Raw readings are DallasTemperature counts,
+// 1/128 °C. 750 ms per 12-bit conversion, halving per bit less, at most:
+// the sensor holds the bus low until it is done, so completion is polled.
+// That needs VDD wired; a parasite-powered sensor can't answer.
+// ============================================
+class Ds18b20 {
+public:
+    static const char* name() { return "DS18B20"; }
+    static const uint8_t WARMUP_CONVERSIONS = 1;   // the first reads 85 °C after power-up
+    static const uint8_t POLL_MS = 5;
+    static const int16_t MIN_CENTI_C = -5500;
+    static const int16_t MAX_CENTI_C = 12500;
+
+    bool     begin(uint8_t pin);
+    void     configure(uint8_t bits);
+    void     startConversion();
+    uint32_t readyMs();
+    bool     conversionDone();
+    bool     readRaw(int32_t& raw);
+    int32_t  lsb() const { return 8 << (12 - bits_); }
+
+    static int32_t toCentiC(int32_t sum, uint32_t count) { return dallasRawToCentiC(sum, count); }
+
+private:
+    OneWire           wire_;
+    DallasTemperature sensor_;
+    DeviceAddress     address_;
+    uint8_t           bits_ = 12;    // power-on default
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================
+// Sensirion SHT30/31/35 on I2C (SENSOR_TYPE SENSOR_SHT3X)
+// Channel id: the I2C address, 0x44 or 0x45 (ADDR pin high). Single-shot
+// measurements without clock stretching; raw readings are the 16-bit
+// temperature word, T = -45 + 175 * raw / 65535 °C. 15 ms per
+// high-repeatability measurement, 4 ms at low, at most; the sensor NACKs
+// reads until it is done, so polling is reading.
+// ============================================
+class Sht3x {
+public:
+    static const char* name() { return "SHT3x"; }
+    static const uint8_t WARMUP_CONVERSIONS = 0;
+    static const uint8_t POLL_MS = 1;
+    static const int16_t MIN_CENTI_C = -4000;
+    static const int16_t MAX_CENTI_C = 12500;
+
+    bool     begin(uint8_t address);
+    void     configure(uint8_t bits);
+    void     startConversion();
+    uint32_t readyMs() const;
+    bool     conversionDone();
+    bool     readRaw(int32_t& raw);
+    int32_t  lsb() const { return 1; }
+
+    static int32_t toCentiC(int32_t sum, uint32_t count);
+
+private:
+    uint8_t address_ = 0x44;
+    uint8_t repeatability_ = 0;      // index into the command table, 0 = high
+    bool    done_  = false;          // conversionDone() has read the result
+    bool    valid_ = false;          // and its CRC matched
+    int32_t raw_   = 0;
+
+    bool decode(int32_t& raw);
+};
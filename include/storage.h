@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Arduino.h>
+#include <time.h>
+
+// ============================================
+// Local storage on LittleFS, with flash wear accounting
+// Logical bytes are counted here; physical programs and erases are counted
+// under the filesystem by wrapping esp_partition_write/erase_range
+// (see build_flags in platformio.ini).
+// ============================================
+// Files on the LittleFS partition
+extern const char* DATA_FILE;   // readings, CSV
+extern const char* LOG_FILE;    // logMessage() lines
+extern const char* INDEX_FILE;  // sparse time index over DATA_FILE
+
+struct FlashWear {
+    uint32_t logicalBytes;      // bytes the firmware asked to store
+    uint32_t programBytes;      // bytes programmed on the filesystem partition
+    uint32_t eraseSectors;      // 4 KB sector erases on the filesystem partition
+    uint32_t otherEraseSectors; // NVS and other partitions (WiFi config, PHY data)
+};
+
+// Call once per wake, before anything touches the filesystem
+void storageBeginWake();
+
+// Appends text to a file in one open/close. False if the file can't be opened.
+bool appendToFile(const char* path, const String& text);
+
+// Appends one CSV row to DATA_FILE with its CRC, writing header (column
+// names, crc16 added here) first if the file is new. epoch is the row's
+// time, 0 for "boot-N" rows written before the clock was set; timed rows
+// feed the time index.
+bool appendReading(const String& row, time_t epoch, const String& header);
+
+// Offset in DATA_FILE of a row boundary at or before the first row timed
+// at or after since. Binary search over INDEX_FILE, so a range read costs
+// a few small reads plus the rows it returns. Rows are assumed to be in
+// time order; 0 when there is no index or nothing to skip.
+size_t readingsOffsetFor(time_t since);
+
+// After a reset that may have cut a write short: truncates DATA_FILE
+// after its last valid row and drops index entries past the new end.
+// Reads at most DATA_RECOVERY_WINDOW bytes. Returns the bytes cut off.
+size_t recoverReadings();
+
+// Deletes DATA_FILE and its index
+bool removeReadings();
+
+const FlashWear& flashWearThisWake();
+const FlashWear& flashWearSincePowerOn();
+
+// Years until the average sector reaches FLASH_ENDURANCE_CYCLES, assuming
+// littlefs spreads erases over the whole partition and the erase rate seen
+// since power-on continues. 0 until there is something to project from.
+float flashLifetimeYears();
+
+// One line on Serial - not the log file, which would add to the wear.
+// Nothing on wakes without Serial (see console.h).
+void printFlashWear();
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================
+// Fixed-point temperatures
+// A reading travels as centi-degrees Celsius in an int16_t (2256 = 22.56 °C)
+// from the sensor's raw count to the CSV row, the log and the JSON payload.
+// Nothing on the way is a float: the C3 has no FPU, so every float
+// multiply, compare or print there is a soft-float library call.
+// ============================================
+#define TEMP_INVALID     INT16_MIN
+
+// Channels in one record: one per sensor (SENSOR_CHANNEL_IDS, sensor.h)
+#define TEMP_MAX_CHANNELS 8
+
+// DallasTemperature::getTemp() counts 1/128 °C; a 12-bit DS18B20 steps by
+// 8 of those (1/16 °C), so x.125 and x.625 land exactly on a half cent.
+// Those round to even, as printf and String(float, 2) did, so rows read the
+// same as before ("22.56", "0.12", "-0.06"). raw may be the sum of count
+// readings, for their mean. int32_t: a glitched scratchpad can hold up to
+// 2047 °C; narrow after the range check.
+inline int32_t dallasRawToCentiC(int32_t raw, uint32_t count = 1) {
+    uint32_t scaled = (uint32_t)(raw < 0 ? -raw : raw) * 100;
+    uint32_t divisor = 128 * count;
+    uint32_t centi = scaled / divisor;
+    uint32_t rest = scaled % divisor;
+    if (rest * 2 > divisor || (rest * 2 == divisor && (centi & 1))) centi++;
+    return raw < 0 ? -(int32_t)centi : (int32_t)centi;
+}
+
+inline int32_t centiCToCentiF(int16_t centiC) {
+    int32_t scaled = (int32_t)centiC * 9;
+    return (scaled >= 0 ? (scaled + 2) / 5 : (scaled - 2) / 5) + 3200;
+}
+
+// The readings of one wake, one per channel, taken together
+struct TempRecord {
+    uint8_t channels;
+    int16_t centiC[TEMP_MAX_CHANNELS];       // TEMP_INVALID: this channel failed
+    int16_t spreadCenti[TEMP_MAX_CHANNELS];  // oversampled readings only, else TEMP_INVALID
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <Arduino.h>
+#include "temperature.h"
+
+// ============================================
+// Wake classes
+// Decided at the top of setup() from RTC state alone, before anything is
+// brought up. A sample-only wake reads the sensor into RTC memory and
+// goes back to sleep: no LED, no banner, no filesystem, no radio. Every
+// other class runs the full wake, which stores the held readings with the
+// new one and uploads them together.
+// ============================================
+enum WakeKind : uint8_t {
+    WAKE_SAMPLE,        // reading into RTC memory only
+    WAKE_UPLOAD,        // UPLOAD_EVERY_N_READINGS readings are due
+    WAKE_SYNC,          // NTP is due, or has never been done
+    WAKE_MAINTENANCE    // cold boot or serial host: recovery, console
+};
+
+// Call after serialBegin(): a wake with Serial up is a maintenance wake
+WakeKind classifyWake(int bootCount, bool timeSynced);
+
+// "sample", "upload", "sync", "maintenance"
+const char* wakeKindName(WakeKind kind);
+
+// ============================================
+// Held readings
+// Taken on sample-only wakes, kept in RTC memory until the next full
+// wake. RTC memory survives deep sleep but not a power cut or a reset.
+// ============================================
+struct HeldReading {
+    time_t     epoch;       // 0: no wall clock yet, the row is "boot-N"
+    int32_t    boot;
+    TempRecord record;
+};
+
+void               holdReading(time_t epoch, int32_t boot, const TempRecord& record);
+uint8_t            heldCount();
+const HeldReading& heldReading(uint8_t index);
+void               clearHeld();
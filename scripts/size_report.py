@@ -0,0 +1,99 @@
+"""Flash, IRAM and DRAM use of the firmware, per build environment.
+
+Runs after every firmware link as a PlatformIO extra script (platformio.ini)
+and prints one row for the environment just built. Run on its own, it
+prints the table for every environment under .pio/build:
+
+    python scripts/size_report.py
+
+Reads the ELF section headers directly, so no toolchain is needed:
+  image  bytes stored in the app partition (everything with contents)
+  flash  code and constants run in place from flash (.flash.*)
+  iram   code copied to instruction RAM at boot (.iram0.*)
+  dram   initialized data + zeroed data (.dram0.*, .noinit)
+  rtc    RTC memory: RTC_DATA_ATTR variables and RTC code (.rtc*)
+  boot   bytes the bootloader copies from flash on every wake (iram, dram
+         data, rtc contents) - the part of the image that costs wake time
+"""
+import glob
+import os
+import struct
+import sys
+
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+
+
+def sections(path):
+    with open(path, "rb") as f:
+        elf = f.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 1:
+        raise ValueError("%s: not a 32-bit ELF file" % path)
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", elf, 0x2E)
+    headers = [struct.unpack_from("<IIIIII", elf, shoff + i * shentsize) for i in range(shnum)]
+    names_at = headers[shstrndx][4]
+    for name, kind, flags, _addr, _offset, size in headers:
+        if not flags & SHF_ALLOC or size == 0:
+            continue
+        end = elf.index(b"\0", names_at + name)
+        yield elf[names_at + name:end].decode(), kind != SHT_NOBITS, size
+
+
+def measure(path):
+    use = dict(image=0, flash=0, iram=0, dram_data=0, dram_bss=0, rtc=0, boot=0)
+    for name, stored, size in sections(path):
+        if stored:
+            use["image"] += size
+        if name.startswith(".flash"):
+            use["flash"] += size
+            continue
+        if name.startswith(".iram0"):
+            use["iram"] += size
+        elif name.startswith(".dram0") or name == ".noinit":
+            use["dram_data" if stored else "dram_bss"] += size
+        elif name.startswith(".rtc"):
+            use["rtc"] += size
+        else:
+            continue
+        if stored:
+            use["boot"] += size
+    return use
+
+
+HEADER = "%-18s %9s %9s %8s %10s %9s %7s %8s" % (
+    "env", "image", "flash", "iram", "dram data", "dram bss", "rtc", "boot")
+
+
+def row(env_name, use):
+    return "%-18s %9d %9d %8d %10d %9d %7d %8d" % (
+        env_name, use["image"], use["flash"], use["iram"], use["dram_data"],
+        use["dram_bss"], use["rtc"], use["boot"])
+
+
+def report_all(build_dir):
+    elves = sorted(glob.glob(os.path.join(build_dir, "*", "firmware.elf")))
+    if not elves:
+        print("no firmware.elf under %s - build an environment first" % build_dir)
+        return 1
+    print(HEADER)
+    for elf in elves:
+        print(row(os.path.basename(os.path.dirname(elf)), measure(elf)))
+    return 0
+
+
+try:
+    Import("env")  # noqa: F821 - defined when PlatformIO runs this script
+except NameError:
+    env = None
+
+if env is not None:
+    def after_link(target, source, env):
+        elf = str(target[0])
+        print(HEADER)
+        print(row(env["PIOENV"], measure(elf)))
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", after_link)
+elif __name__ == "__main__":
+    here = os.path.dirname(os.path.abspath(__file__))
+    sys.exit(report_all(os.path.join(here, "..", ".pio", "build")))
@@ -0,0 +1,80 @@
+#include "ap_history.h"
+
+#include "config.h"
+
+static RTC_DATA_ATTR ApRecord history[AP_HISTORY_MAX];
+static RTC_DATA_ATTR int8_t   lastJoined = -1;
+
+// Higher is likelier
+static uint32_t score(uint8_t index) {
+    return (index == lastJoined ? 0x10000UL : 0) + history[index].joins;
+}
+
+uint8_t apProbeOrder(uint8_t networks, uint8_t* order, uint8_t max) {
+    if (networks > AP_HISTORY_MAX) networks = AP_HISTORY_MAX;
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < networks; i++) {
+        if (history[i].channel == 0) continue;
+        // Insertion into the top max by score
+        uint8_t at = count < max ? count++ : max;
+        while (at > 0 && score(order[at - 1]) < score(i)) {
+            if (at < max) order[at] = order[at - 1];
+            at--;
+        }
+        if (at < max) order[at] = i;
+    }
+    return count;
+}
+
+void apJoined(uint8_t index, uint8_t channel, int8_t rssi) {
+    if (index >= AP_HISTORY_MAX) return;
+    ApRecord& record = history[index];
+    // Down at once, back up slowly: one weak join outweighs a run of good ones
+    if (record.joins == 0 || rssi <= record.rssiFloor) {
+        record.rssiFloor = rssi;
+        record.floorAge = 0;
+    } else if (++record.floorAge >= WIFI_TX_RECOVER_JOINS) {
+        record.rssiFloor++;
+        record.floorAge = 0;
+    }
+    if (record.joins < 0xFFFF) record.joins++;
+    record.channel = channel;
+    record.rssi = rssi;
+    lastJoined = (int8_t)index;
+}
+
+const ApRecord& apRecord(uint8_t index) {
+    return history[index];
+}
+
+// ============================================
+// TX power
+// ============================================
+// The wifi_power_t steps, highest first, down to 2 dBm
+static const int8_t TX_STEPS[] = { 78, 76, 74, 68, 60, 52, 44, 34, 28, 20, 8 };
+
+int8_t apTxPower(uint8_t index) {
+#if WIFI_TX_ADAPTIVE
+    if (index >= AP_HISTORY_MAX) return AP_TX_POWER_MAX;
+    const ApRecord& record = history[index];
+    if (record.joins == 0) return AP_TX_POWER_MAX;
+
+    // Lowest step that still leaves the AP hearing us at the target
+    int32_t marginQdB = ((int32_t)record.rssiFloor - WIFI_TX_RSSI_TARGET_DBM) * 4;
+    int8_t power = AP_TX_POWER_MAX;
+    for (int8_t step : TX_STEPS) {
+        if (AP_TX_POWER_MAX - step <= marginQdB) power = step;
+    }
+    return power;
+#else
+    (void)index;
+    return AP_TX_POWER_MAX;
+#endif
+}
+
+void apTxFailed(uint8_t index) {
+    if (index >= AP_HISTORY_MAX) return;
+    ApRecord& record = history[index];
+    if (record.rssiFloor > WIFI_TX_RSSI_TARGET_DBM) record.rssiFloor = WIFI_TX_RSSI_TARGET_DBM;
+    record.floorAge = 0;
+}
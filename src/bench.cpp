@@ -0,0 +1,139 @@
+#ifdef BENCH_HARNESS
+
+#include "bench.h"
+
+#include <Arduino.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "format.h"
+#include "oversample.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+#include <esp_timer.h>
+static uint64_t nowNs() { return (uint64_t)esp_timer_get_time() * 1000ULL; }
+#else
+#include <chrono>
+static uint64_t nowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+// ============================================
+// Allocation counter
+// Linked with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc so every
+// heap allocation (String, ArduinoJson, operator new on target) passes here
+// ============================================
+static volatile uint32_t s_allocs = 0;
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    s_allocs = s_allocs + 1;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+    s_allocs = s_allocs + 1;
+    return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    s_allocs = s_allocs + 1;
+    return __real_realloc(ptr, size);
+}
+}
+
+// ============================================
+// Stages - fixed inputs shaped like a real wake
+// ============================================
+static volatile size_t s_sink;
+
+static struct tm fixtureTime() {
+    struct tm t = {};
+    t.tm_year = 2026 - 1900;
+    t.tm_mon  = 1;
+    t.tm_mday = 17;
+    t.tm_hour = 10;
+    t.tm_min  = 0;
+    t.tm_sec  = 2;
+    return t;
+}
+
+static const struct tm s_time      = fixtureTime();
+static const String    s_timestamp = "2026-02-17T10:00:02";
+static const String    s_message   = "Sent 22.56°C (boot #1440)";
+
+static void benchIsoTime()   { s_sink = s_sink + formatIsoTime(s_time).length(); }
+static void benchLogLine()   { s_sink = s_sink + formatLogLine(s_timestamp, s_message).length(); }
+static const TempRecord s_record = { 1, { 2256 }, { TEMP_INVALID } };
+
+static void benchCsvRow()    { s_sink = s_sink + formatCsvRow(s_timestamp, s_record).length(); }
+static void benchPayload()   { s_sink = s_sink + buildPayload(s_record, s_timestamp).length(); }
+
+// Five 9-bit samples (0.5 °C steps, 1/128 °C counts) with one glitch
+static void benchFilter() {
+    int32_t samples[] = { 2880, 2816, 10880, 2880, 2880 };
+    FilteredSamples filtered;
+    filterSamples(samples, 5, 64, -7040, filtered);
+    s_sink = s_sink + filtered.kept;
+}
+
+struct Bench {
+    const char* name;
+    void (*run)();
+};
+
+static const Bench BENCHES[] = {
+    { "iso_timestamp", benchIsoTime },
+    { "log_line",      benchLogLine },
+    { "csv_row",       benchCsvRow },
+    { "json_payload",  benchPayload },
+    { "median_filter", benchFilter },
+};
+
+// Each stage doubles its iteration count until one batch takes this long,
+// then reports the fastest of a few batches of that size
+static const uint64_t MIN_BATCH_NS   = 50000000ULL;
+static const uint32_t MAX_ITERATIONS = 1UL << 24;
+static const int      BATCHES        = 5;
+
+static uint64_t timeBatch(const Bench& bench, uint32_t iterations, uint32_t& allocs) {
+    uint32_t allocsBefore = s_allocs;
+    uint64_t start = nowNs();
+    for (uint32_t i = 0; i < iterations; i++) bench.run();
+    uint64_t elapsed = nowNs() - start;
+    allocs = s_allocs - allocsBefore;
+    yield();
+    return elapsed;
+}
+
+void runBenchmarks(BenchEmit emit) {
+    for (const Bench& bench : BENCHES) {
+        bench.run();    // warm-up: first-call allocations, caches
+        uint32_t iterations = 16;
+        uint32_t allocs;
+        uint64_t best = timeBatch(bench, iterations, allocs);
+        while (best < MIN_BATCH_NS && iterations < MAX_ITERATIONS) {
+            iterations *= 2;
+            best = timeBatch(bench, iterations, allocs);
+        }
+        for (int i = 1; i < BATCHES; i++) {
+            uint64_t elapsed = timeBatch(bench, iterations, allocs);
+            if (elapsed < best) best = elapsed;
+        }
+        BenchResult result = { bench.name, (double)best / iterations, (double)allocs / iterations };
+        emit(result);
+    }
+}
+
+void formatBenchLine(const BenchResult& result, char* buf, size_t size) {
+    snprintf(buf, size, "bench %-14s %10.1f ns/op %6.2f allocs/op",
+        result.name, result.nsPerOp, result.allocsPerOp);
+}
+
+#endif // BENCH_HARNESS
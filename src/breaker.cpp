@@ -0,0 +1,40 @@
+#include "breaker.h"
+
+#include "config.h"
+
+static_assert(SERVER_BREAKER_TRIP >= 1, "SERVER_BREAKER_TRIP must be at least 1");
+static_assert(SERVER_BREAKER_BACKOFF_MIN >= 1 && SERVER_BREAKER_BACKOFF_MIN <= SERVER_BREAKER_BACKOFF_MAX &&
+              SERVER_BREAKER_BACKOFF_MAX <= 255, "SERVER_BREAKER_BACKOFF_MIN/MAX out of range");
+
+static RTC_DATA_ATTR BreakerState state    = BREAKER_CLOSED;
+static RTC_DATA_ATTR uint8_t      failures = 0;   // in a row, while closed
+static RTC_DATA_ATTR uint8_t      backoff  = SERVER_BREAKER_BACKOFF_MIN;
+static RTC_DATA_ATTR uint8_t      skipped  = 0;   // this open spell
+
+bool breakerAllows() {
+    if (state != BREAKER_OPEN) return true;
+    if (++skipped <= backoff) return false;
+    state = BREAKER_HALF_OPEN;
+    return true;
+}
+
+void breakerServerOk() {
+    state = BREAKER_CLOSED;
+    failures = 0;
+    backoff = SERVER_BREAKER_BACKOFF_MIN;
+}
+
+void breakerServerFailed() {
+    if (state == BREAKER_HALF_OPEN) {
+        // The probe failed: longer this time
+        backoff = backoff > SERVER_BREAKER_BACKOFF_MAX / 2 ? SERVER_BREAKER_BACKOFF_MAX : backoff * 2;
+    } else if (++failures < SERVER_BREAKER_TRIP) {
+        return;
+    }
+    state = BREAKER_OPEN;
+    failures = 0;
+    skipped = 0;
+}
+
+BreakerState breakerState() { return state; }
+uint8_t      breakerBackoff() { return backoff; }
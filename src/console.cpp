@@ -0,0 +1,326 @@
+#include "console.h"
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <time.h>
+
+#include "bench.h"
+#include "config.h"
+#include "diagnostics.h"
+#include "storage.h"
+
+#if SERIAL_OUTPUT
+
+// ============================================
+// Serial policy
+// ============================================
+static bool serialOn;
+
+static bool hostAttached() {
+#if ARDUINO_USB_CDC_ON_BOOT
+    return (bool)Serial;    // USB CDC: true while a host has the port open
+#else
+    return false;           // UART bridge: can't tell
+#endif
+}
+
+bool serialBegin() {
+    serialOn = esp_reset_reason() != ESP_RST_DEEPSLEEP || hostAttached();
+    if (serialOn) {
+        Serial.begin(115200);
+        delay(SERIAL_SETTLE_MS);     // let the monitor catch the banner
+    }
+    return serialOn;
+}
+
+bool serialUp() { return serialOn; }
+
+// ============================================
+// Framed output
+// ============================================
+static uint32_t frameCrc;
+static uint32_t frameLines;
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t len) {
+    crc = ~crc;
+    while (len--) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1)));
+    }
+    return ~crc;
+}
+
+static void beginFrame(const char* command) {
+    frameCrc = 0;
+    frameLines = 0;
+    Serial.printf("#BEGIN %s\n", command);
+}
+
+// One body line; text need not be terminated, the newline is added here
+static void frameLine(const char* text, size_t len) {
+    Serial.write((const uint8_t*)text, len);
+    Serial.write('\n');
+    frameCrc = crc32Update(frameCrc, (const uint8_t*)text, len);
+    frameCrc = crc32Update(frameCrc, (const uint8_t*)"\n", 1);
+    frameLines++;
+}
+
+static void framef(const char* format, ...) __attribute__((format(printf, 1, 2)));
+static void framef(const char* format, ...) {
+    char line[96];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (n < 0) return;
+    frameLine(line, (size_t)n < sizeof(line) ? (size_t)n : sizeof(line) - 1);
+}
+
+static void endFrame() {
+    Serial.printf("#END %u %08x\n", (unsigned)frameLines, (unsigned)frameCrc);
+}
+
+// ============================================
+// Line-at-a-time file reader with a fixed buffer
+// ============================================
+struct LineReader {
+    File   file;
+    char   buf[256];
+    size_t len = 0;
+    size_t pos = 0;
+
+    // Next line without its terminator; false at end of file.
+    // Lines longer than the output buffer are truncated.
+    bool next(char* out, size_t size, size_t& outLen) {
+        outLen = 0;
+        bool any = false;
+        for (;;) {
+            if (pos == len) {
+                len = file.read((uint8_t*)buf, sizeof(buf));
+                pos = 0;
+                if (len == 0) return any;
+            }
+            char c = buf[pos++];
+            any = true;
+            if (c == '\n') return true;
+            if (c != '\r' && outLen + 1 < size) out[outLen++] = c;
+        }
+    }
+};
+
+static size_t fileSize(const char* path) {
+    File file = LittleFS.open(path, FILE_READ);
+    if (!file) return 0;
+    size_t size = file.size();
+    file.close();
+    return size;
+}
+
+// ============================================
+// Commands
+// ============================================
+static void cmdStats(int bootCount) {
+    beginFrame("stats");
+    framef("boot=%d", bootCount);
+    framef("reset_reason=%d", (int)esp_reset_reason());
+    framef("uptime_ms=%lu", (unsigned long)millis());
+    framef("fs_total=%u", (unsigned)LittleFS.totalBytes());
+    framef("fs_used=%u", (unsigned)LittleFS.usedBytes());
+    framef("data_bytes=%u", (unsigned)fileSize(DATA_FILE));
+    framef("log_bytes=%u", (unsigned)fileSize(LOG_FILE));
+    framef("undelivered=%u", (unsigned)diagUndeliveredReadings());
+    framef("failed_uploads=%u", (unsigned)diagFailedUploads());
+    framef("min_free_heap=%u", (unsigned)ESP.getMinFreeHeap());
+
+    const FlashWear& wear = flashWearSincePowerOn();
+    framef("flash_stored=%u", (unsigned)wear.logicalBytes);
+    framef("flash_programmed=%u", (unsigned)wear.programBytes);
+    framef("flash_erases=%u", (unsigned)wear.eraseSectors);
+    framef("flash_other_erases=%u", (unsigned)wear.otherEraseSectors);
+    framef("flash_life_years=%.1f", flashLifetimeYears());
+    endFrame();
+}
+
+// Scans back from the end in blocks until it has passed N line breaks,
+// then streams forward - cost follows N, not the size of the log
+static void cmdTail(long lines) {
+    File file = LittleFS.open(LOG_FILE, FILE_READ);
+    if (!file) {
+        Serial.println("#ERR no log");
+        return;
+    }
+
+    size_t size = file.size();
+    size_t start = size;
+    long breaks = 0;
+    char block[128];
+    while (start > 0 && breaks < lines) {
+        size_t chunk = start < sizeof(block) ? start : sizeof(block);
+        start -= chunk;
+        file.seek(start);
+        file.read((uint8_t*)block, chunk);
+        for (size_t i = chunk; i-- > 0;) {
+            // The newline ending the last line doesn't start one
+            if (block[i] == '\n' && start + i + 1 < size && ++breaks >= lines) {
+                start += i + 1;
+                break;
+            }
+        }
+    }
+
+    beginFrame("tail");
+    file.seek(start);
+    LineReader reader;
+    reader.file = file;
+    char line[160];
+    size_t len;
+    while (reader.next(line, sizeof(line), len)) frameLine(line, len);
+    endFrame();
+    file.close();
+}
+
+static void formatBound(time_t epoch, char* out, size_t size) {
+    struct tm t;
+    gmtime_r(&epoch, &t);
+    strftime(out, size, "%Y-%m-%dT%H:%M:%S", &t);
+}
+
+// Rows carry ISO 8601 UTC timestamps, which sort as text: compare against
+// the bounds formatted the same way instead of parsing every row. The time
+// index gives the starting offset, and rows are in time order, so the read
+// stops at the first row past 'until'.
+static void cmdExport(time_t since, time_t until) {
+    File file = LittleFS.open(DATA_FILE, FILE_READ);
+    if (!file) {
+        Serial.println("#ERR no data");
+        return;
+    }
+
+    char from[20];
+    char to[20];
+    formatBound(since, from, sizeof(from));
+    formatBound(until, to, sizeof(to));
+    const size_t boundLen = sizeof(from) - 1;
+
+    beginFrame("export");
+    LineReader reader;
+    reader.file = file;
+    char line[96];
+    size_t len;
+
+    // Header always, then straight to the first block that may qualify
+    if (reader.next(line, sizeof(line), len)) frameLine(line, len);
+    size_t start = since > 0 ? readingsOffsetFor(since) : 0;
+    if (start > 0) {
+        file.seek(start);
+        reader.len = reader.pos = 0;
+    }
+
+    while (reader.next(line, sizeof(line), len)) {
+        // "boot-N" rows (no clock yet) only in a full export
+        bool timed = len >= boundLen && line[0] != 'b';
+        if (timed && until > 0 && strncmp(line, to, boundLen) > 0) break;
+        bool keep = (since == 0 && until == 0) || (timed && strncmp(line, from, boundLen) >= 0);
+        if (keep) frameLine(line, len);
+    }
+    endFrame();
+    file.close();
+}
+
+static void cmdClearBacklog() {
+    size_t bytes = fileSize(DATA_FILE);
+    if (!removeReadings()) {
+        Serial.println("#ERR remove failed");
+        return;
+    }
+    diagClearUndelivered();
+    beginFrame("clear");
+    framef("removed %s %u", DATA_FILE, (unsigned)bytes);
+    endFrame();
+}
+
+#ifdef BENCH_HARNESS
+static void emitBench(const BenchResult& result) {
+    char line[80];
+    formatBenchLine(result, line, sizeof(line));
+    frameLine(line, strlen(line));
+}
+#endif
+
+static void cmdHelp() {
+    beginFrame("help");
+    framef("stats");
+    framef("tail log N");
+    framef("export since <epoch> [until <epoch>]");
+    framef("clear backlog");
+#ifdef BENCH_HARNESS
+    framef("bench");
+#endif
+    framef("exit");
+    endFrame();
+}
+
+// False on "exit"
+static bool execute(char* line, int bootCount) {
+    while (*line == ' ') line++;
+    long n;
+    long m;
+    if (strcmp(line, "stats") == 0) {
+        cmdStats(bootCount);
+    } else if (sscanf(line, "tail log %ld", &n) == 1 && n > 0) {
+        cmdTail(n);
+    } else if (sscanf(line, "export since %ld until %ld", &n, &m) == 2 && n >= 0 && m >= n) {
+        cmdExport((time_t)n, (time_t)m);
+    } else if (sscanf(line, "export since %ld", &n) == 1 && n >= 0) {
+        cmdExport((time_t)n, 0);
+    } else if (strcmp(line, "clear backlog") == 0) {
+        cmdClearBacklog();
+#ifdef BENCH_HARNESS
+    } else if (strcmp(line, "bench") == 0) {
+        beginFrame("bench");
+        runBenchmarks(emitBench);
+        endFrame();
+#endif
+    } else if (strcmp(line, "help") == 0) {
+        cmdHelp();
+    } else if (strcmp(line, "exit") == 0) {
+        return false;
+    } else if (line[0] != '\0') {
+        Serial.printf("#ERR unknown command: %s\n", line);
+    }
+    return true;
+}
+
+// ============================================
+// Window
+// ============================================
+void consoleRun(int bootCount) {
+    if (!serialUp()) return;
+
+    Serial.printf("Console open for %d ms - type 'help'\n", CONSOLE_WINDOW_MS);
+    char line[64];
+    size_t len = 0;
+    unsigned long start = millis();
+    while (millis() - start < CONSOLE_WINDOW_MS) {
+        while (Serial.available()) {
+            char c = (char)Serial.read();
+            if (c != '\n' && c != '\r') {
+                if (len + 1 < sizeof(line)) line[len++] = c;
+                continue;
+            }
+            line[len] = '\0';
+            len = 0;
+            if (!execute(line, bootCount)) return;
+            start = millis();
+        }
+        delay(10);
+    }
+}
+
+#else // !SERIAL_OUTPUT
+
+bool serialBegin() { return false; }
+bool serialUp()    { return false; }
+void consoleRun(int) {}
+
+#endif // SERIAL_OUTPUT
@@ -0,0 +1,142 @@
+#include "diagnostics.h"
+
+#include <LittleFS.h>
+#include <time.h>
+#include "breaker.h"
+#include "config.h"
+
+// ============================================
+// State that outlives the wake
+// ============================================
+static RTC_DATA_ATTR uint16_t lastWakeMs          = 0;
+static RTC_DATA_ATTR uint16_t lastUploadMs        = 0;
+static RTC_DATA_ATTR uint16_t failedUploads       = 0;
+static RTC_DATA_ATTR uint16_t undeliveredReadings = 0;
+static RTC_DATA_ATTR uint32_t uploadAttempts      = 0;
+
+// ============================================
+// This wake
+// ============================================
+static uint32_t  phaseStartMs;
+static DiagPhase currentPhase;
+static uint16_t  phaseMs[PHASE_COUNT];
+static int8_t    wifiRssi;
+static uint8_t   wifiAttempts;
+static int8_t    wifiApIndex;
+static int8_t    wifiTxPower;
+
+static uint16_t saturate16(uint32_t value) {
+    return value > 0xFFFF ? 0xFFFF : (uint16_t)value;
+}
+
+void diagBeginWake() {
+    phaseStartMs = millis();
+    currentPhase = PHASE_INIT;
+    memset(phaseMs, 0, sizeof(phaseMs));
+    wifiRssi = 0;
+    wifiAttempts = 0;
+    wifiApIndex = -1;
+    wifiTxPower = 0;
+}
+
+void diagPhase(DiagPhase phase) {
+    uint32_t now = millis();
+    phaseMs[currentPhase] = saturate16(phaseMs[currentPhase] + (now - phaseStartMs));
+    phaseStartMs = now;
+    currentPhase = phase;
+}
+
+void diagWifi(int8_t rssi, uint8_t attempts, int8_t apIndex, int8_t txPower) {
+    wifiRssi = rssi;
+    wifiAttempts = attempts;
+    wifiApIndex = apIndex;
+    wifiTxPower = txPower;
+}
+
+void diagReadingUndelivered() {
+    if (undeliveredReadings < 0xFFFF) undeliveredReadings++;
+}
+
+void diagUploadResult(bool ok) {
+    if (ok) {
+        failedUploads = 0;
+    } else {
+        if (failedUploads < 0xFFFF) failedUploads++;
+        diagReadingUndelivered();
+    }
+}
+
+uint16_t diagFailedUploads()       { return failedUploads; }
+uint16_t diagUndeliveredReadings() { return undeliveredReadings; }
+void     diagClearUndelivered()    { undeliveredReadings = 0; }
+
+void diagEndWake() {
+    diagPhase(currentPhase);
+    lastWakeMs = saturate16(millis());
+    lastUploadMs = phaseMs[PHASE_UPLOAD];
+}
+
+// ============================================
+// Encoding
+// ============================================
+static uint8_t* put8(uint8_t* p, uint8_t v)   { *p++ = v; return p; }
+static uint8_t* put16(uint8_t* p, uint16_t v) { *p++ = v & 0xFF; *p++ = v >> 8; return p; }
+static uint8_t* put32(uint8_t* p, uint32_t v) { p = put16(p, v & 0xFFFF); return put16(p, v >> 16); }
+
+static void base64(const uint8_t* in, size_t len, char* out) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    size_t i = 0;
+    for (; i + 2 < len; i += 3) {
+        uint32_t v = ((uint32_t)in[i] << 16) | ((uint32_t)in[i + 1] << 8) | in[i + 2];
+        *out++ = alphabet[(v >> 18) & 63];
+        *out++ = alphabet[(v >> 12) & 63];
+        *out++ = alphabet[(v >> 6) & 63];
+        *out++ = alphabet[v & 63];
+    }
+    if (i < len) {
+        uint32_t v = (uint32_t)in[i] << 16;
+        if (i + 1 < len) v |= (uint32_t)in[i + 1] << 8;
+        *out++ = alphabet[(v >> 18) & 63];
+        *out++ = alphabet[(v >> 12) & 63];
+        *out++ = i + 1 < len ? alphabet[(v >> 6) & 63] : '=';
+        *out++ = '=';
+    }
+    *out = '\0';
+}
+
+const char* diagForUpload() {
+    static char encoded[(DIAG_RECORD_BYTES + 2) / 3 * 4 + 1];
+
+    uint32_t attempt = uploadAttempts++;
+    if (DIAGNOSTICS_EVERY_N_UPLOADS == 0 || attempt % DIAGNOSTICS_EVERY_N_UPLOADS != 0) return nullptr;
+
+    struct tm timeinfo;
+    uint8_t flags = 0;
+    if (getLocalTime(&timeinfo, 0))       flags |= 0x01;
+    if (failedUploads > 0)                flags |= 0x02;
+    if (breakerState() != BREAKER_CLOSED) flags |= 0x04;
+
+    size_t freeBytes = LittleFS.totalBytes() - LittleFS.usedBytes();
+
+    uint8_t record[DIAG_RECORD_BYTES];
+    uint8_t* p = record;
+    p = put8(p, DIAG_VERSION);
+    p = put8(p, (uint8_t)esp_reset_reason());
+    p = put16(p, saturate16(millis()));
+    p = put16(p, lastWakeMs);
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        p = put16(p, phase == PHASE_UPLOAD ? lastUploadMs : phaseMs[phase]);
+    }
+    p = put8(p, (uint8_t)wifiRssi);
+    p = put8(p, wifiAttempts);
+    p = put8(p, (uint8_t)wifiApIndex);
+    p = put8(p, flags);
+    p = put32(p, ESP.getMinFreeHeap());
+    p = put16(p, saturate16(freeBytes / 1024));
+    p = put16(p, failedUploads);
+    p = put16(p, undeliveredReadings);
+    p = put8(p, (uint8_t)wifiTxPower);
+
+    base64(record, sizeof(record), encoded);
+    return encoded;
+}
@@ -0,0 +1,88 @@
+#include "executor.h"
+
+// ============================================
+// Task
+// ============================================
+void Task::runAfter(Task& task) {
+    if (afterCount_ < TASK_MAX_AFTER) after_[afterCount_++] = &task;
+}
+
+uint32_t Task::remainingMs(uint32_t nowMs) const {
+    if (budgetMs == UINT32_MAX) return UINT32_MAX;
+    uint32_t spent = nowMs - startedMs;
+    return spent < budgetMs ? budgetMs - spent : 0;
+}
+
+// ============================================
+// Executor
+// ============================================
+void Executor::add(Task& task) {
+    if (count_ < EXECUTOR_MAX_TASKS) tasks_[count_++] = &task;
+}
+
+bool Executor::ready(const Task& task) const {
+    for (uint8_t i = 0; i < task.afterCount_; i++) {
+        if (!task.after_[i]->finished()) return false;
+    }
+    return true;
+}
+
+void Executor::run() {
+    EventBits_t events = 0;
+    for (;;) {
+        // One pass: start what is ready, cancel what is out of budget,
+        // resume the rest. Another pass at once if anything finished or
+        // started, as that may let other tasks go on.
+        bool changed = false;
+        for (uint8_t i = 0; i < count_; i++) {
+            Task& task = *tasks_[i];
+            if (task.finished()) continue;
+            uint32_t nowMs = millis();
+            if (task.state == TASK_WAITING) {
+                if (!ready(task)) continue;
+                task.state = TASK_RUNNING;
+                task.startedMs = nowMs;
+                changed = true;
+            }
+            if (task.remainingMs(nowMs) == 0) {
+                diagPhase(task.phase);
+                task.cancel();
+                task.state = TASK_CANCELLED;
+                changed = true;
+                continue;
+            }
+            diagPhase(task.phase);
+            task.resumeAtMs = UINT32_MAX;
+            task.state = task.resume(nowMs, events);
+            changed |= task.finished();
+        }
+        events = 0;
+        if (changed) continue;
+
+        // Nothing can go on: wait for an event or the soonest resume time
+        // or budget. Waiting tasks can't start until a running one ends.
+        uint32_t nowMs = millis();
+        uint32_t waitMs = UINT32_MAX;
+        Task* first = nullptr;
+        for (uint8_t i = 0; i < count_; i++) {
+            Task& task = *tasks_[i];
+            if (task.state != TASK_RUNNING) continue;
+            if (!first) first = &task;
+            if (task.resumeAtMs != UINT32_MAX) {
+                int32_t untilMs = (int32_t)(task.resumeAtMs - nowMs);
+                if (untilMs < 0) untilMs = 0;
+                if ((uint32_t)untilMs < waitMs) waitMs = (uint32_t)untilMs;
+            }
+            uint32_t remaining = task.remainingMs(nowMs);
+            if (remaining < waitMs) waitMs = remaining;
+        }
+        if (!first) return;
+        diagPhase(first->phase);
+        // Cleared by hand: on a timeout the wait returns bits set at that
+        // instant without clearing them
+        events = xEventGroupWaitBits(events_, EXECUTOR_EVENT_BITS, pdFALSE, pdFALSE,
+                                     waitMs == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(waitMs)) &
+                 EXECUTOR_EVENT_BITS;
+        if (events) xEventGroupClearBits(events_, events);
+    }
+}
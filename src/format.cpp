@@ -0,0 +1,101 @@
+#include "format.h"
+
+#include <ArduinoJson.h>
+
+#include "config.h"
+
+String formatIsoTime(const struct tm& timeinfo) {
+    char buf[20];
+    strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &timeinfo);
+    return String(buf);
+}
+
+String formatLogLine(const String& timestamp, const String& message) {
+    return "[" + timestamp + "] " + message;
+}
+
+size_t formatCenti(int32_t centi, char* out) {
+    char text[TEMP_TEXT_BYTES];
+    char* end = text + sizeof(text);
+    char* p = end;
+    uint32_t v = centi < 0 ? 0u - (uint32_t)centi : (uint32_t)centi;
+    *--p = (char)('0' + v % 10);
+    *--p = (char)('0' + v / 10 % 10);
+    *--p = '.';
+    v /= 100;
+    do *--p = (char)('0' + v % 10); while (v /= 10);
+    if (centi < 0) *--p = '-';
+
+    size_t len = (size_t)(end - p);
+    memcpy(out, p, len);
+    out[len] = '\0';
+    return len;
+}
+
+String formatCsvHeader(uint8_t channels) {
+    String header = "timestamp,temperature_celsius";
+    for (uint8_t ch = 2; ch <= channels; ch++) header += ",temperature_celsius_" + String(ch);
+    return header;
+}
+
+String formatCsvRow(const String& timestamp, const TempRecord& record) {
+    char row[20 + TEMP_MAX_CHANNELS * TEMP_TEXT_BYTES];
+    size_t len = 0;
+    for (uint8_t ch = 0; ch < record.channels; ch++) {
+        row[len++] = ',';
+        if (record.centiC[ch] != TEMP_INVALID) len += formatCenti(record.centiC[ch], row + len);
+    }
+    row[len] = '\0';
+    return timestamp + row;
+}
+
+// null for TEMP_INVALID
+static void addCenti(JsonArray array, int16_t centi, char* text) {
+    if (centi == TEMP_INVALID) {
+        array.add(nullptr);
+    } else {
+        formatCenti(centi, text);
+        array.add(serialized(text));
+    }
+}
+
+String buildPayload(const TempRecord& record, const String& timestamp, const char* diag) {
+    // Numbers go in as JSON text, so the payload never holds a float
+    char text[2 * TEMP_MAX_CHANNELS + 2][TEMP_TEXT_BYTES];
+    char* next = text[0];
+
+    JsonDocument doc;
+    if (record.centiC[0] == TEMP_INVALID) {
+        doc["temperature"] = nullptr;
+    } else {
+        formatCenti(record.centiC[0], next);
+        doc["temperature"] = serialized(next);
+        next += TEMP_TEXT_BYTES;
+    }
+    doc["unit"]        = "celsius";
+    doc["timestamp"]   = timestamp;
+    doc["device"]      = DEVICE_NAME;
+    if (diag) doc["diag"] = diag;
+
+    bool oversampled = false;
+    for (uint8_t ch = 0; ch < record.channels; ch++) oversampled |= record.spreadCenti[ch] != TEMP_INVALID;
+    if (record.channels == 1 && oversampled) {
+        formatCenti(record.spreadCenti[0], next);
+        doc["spread"] = serialized(next);
+    } else if (record.channels > 1) {
+        JsonArray channels = doc["channels"].to<JsonArray>();
+        for (uint8_t ch = 0; ch < record.channels; ch++, next += TEMP_TEXT_BYTES) {
+            addCenti(channels, record.centiC[ch], next);
+        }
+        if (oversampled) {
+            JsonArray spreads = doc["spreads"].to<JsonArray>();
+            for (uint8_t ch = 0; ch < record.channels; ch++, next += TEMP_TEXT_BYTES) {
+                addCenti(spreads, record.spreadCenti[ch], next);
+            }
+        }
+    }
+
+    String payload;
+    serializeJson(doc, payload);
+    return payload;
+}
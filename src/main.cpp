@@ -1,13 +1,24 @@
 #include <Arduino.h>
 #include <WiFi.h>
-#include <WiFiMulti.h>
 #include <HTTPClient.h>
-#include <OneWire.h>
-#include <DallasTemperature.h>
-#include <ArduinoJson.h>
+#include <WiFiClientSecure.h>
 #include <LittleFS.h>
 #include <time.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <esp_sntp.h>
 #include "config.h"
+#include "format.h"
+#include "temperature.h"
+#include "sensor.h"
+#include "diagnostics.h"
+#include "storage.h"
+#include "console.h"
+#include "log.h"
+#include "wake.h"
+#include "ap_history.h"
+#include "executor.h"
+#include "breaker.h"
 
 // ============================================
 // RTC Memory - persists across deep sleep cycles
@@ -16,17 +27,31 @@ RTC_DATA_ATTR int bootCount = 0;
 RTC_DATA_ATTR bool timeSynced = false;
 
 // ============================================
-// Sensor Setup
+// WiFi and Sensor Setup
 // ============================================
-WiFiMulti wifiMulti;
-OneWire oneWire(ONE_WIRE_PIN);
-DallasTemperature sensors(&oneWire);
+struct Network { const char* ssid; const char* pass; };
+const Network networks[] = WIFI_NETWORKS;
+constexpr uint8_t NETWORK_COUNT = sizeof(networks) / sizeof(networks[0]);
+static_assert(NETWORK_COUNT <= AP_HISTORY_MAX, "too many WIFI_NETWORKS");
+
+// One sensor per channel, all converting at once
+const uint8_t sensorIds[] = SENSOR_CHANNEL_IDS;
+constexpr uint8_t SENSOR_CHANNELS = sizeof(sensorIds) / sizeof(sensorIds[0]);
+Sensors<SensorDriver, SENSOR_CHANNELS> sensors(sensorIds);
 
 // ============================================
-// Local storage
+// Filesystem - mounted on first use, so a sample-only wake that has
+// nothing to log never mounts it
 // ============================================
-const char* DATA_FILE = "/temperature_data.csv";
-const char* LOG_FILE  = "/thermometer.log";
+bool fsMounted = false;
+
+void mountFilesystem() {
+    if (fsMounted) return;
+    fsMounted = true;
+    if (!LittleFS.begin(true)) {
+        SERIAL_PRINTLN("LittleFS mount failed");
+    }
+}
 
 // ============================================
 // Logging
@@ -36,19 +61,14 @@ void logMessage(const String& message) {
 
     struct tm timeinfo;
     if (getLocalTime(&timeinfo)) {
-        char buf[20];
-        strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &timeinfo);
-        timestamp = String(buf);
+        timestamp = formatIsoTime(timeinfo);
     }
 
-    String logLine = "[" + timestamp + "] " + message;
-    Serial.println(logLine);
+    String logLine = formatLogLine(timestamp, message);
+    SERIAL_PRINTLN(logLine);
 
-    File file = LittleFS.open(LOG_FILE, FILE_APPEND);
-    if (file) {
-        file.println(logLine);
-        file.close();
-    }
+    mountFilesystem();
+    appendToFile(LOG_FILE, logLine + "\r\n");
 }
 
 // ============================================
@@ -66,49 +86,205 @@ void ledBlink(int times, int delayMs = 100) {
 // ============================================
 // WiFi
 // ============================================
-bool connectWiFi() {
-    if (WiFi.status() == WL_CONNECTED) return true;
+// Index into WIFI_NETWORKS of the network joined, -1 if none
+int8_t joinedNetwork() {
+    for (uint8_t i = 0; i < NETWORK_COUNT; i++) {
+        if (WiFi.SSID() == networks[i].ssid) return (int8_t)i;
+    }
+    return -1;
+}
 
-    logMessage("Connecting to WiFi...");
+// Driver callbacks set these; the wake's tasks wait on them through the
+// executor rather than polling
+#define WIFI_UP_BIT     (1 << 0)    // DHCP done
+#define WIFI_DOWN_BIT   (1 << 1)    // attempt failed or link lost
+#define WIFI_SCAN_BIT   (1 << 2)    // scan results in
+#define TIME_SET_BIT    (1 << 3)    // SNTP set the clock
+
+EventGroupHandle_t wakeEvents = nullptr;
+
+void onWiFiEvent(arduino_event_id_t event, arduino_event_info_t info) {
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+        xEventGroupSetBits(wakeEvents, WIFI_UP_BIT);
+    } else if (event == ARDUINO_EVENT_WIFI_SCAN_DONE) {
+        xEventGroupSetBits(wakeEvents, WIFI_SCAN_BIT);
+    } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED &&
+               info.wifi_sta_disconnected.reason != WIFI_REASON_ASSOC_LEAVE) {
+        // ASSOC_LEAVE is our own disconnect() ending an attempt
+        xEventGroupSetBits(wakeEvents, WIFI_DOWN_BIT);
+    }
+}
 
-    unsigned long startTime = millis();
-    while (wifiMulti.run() != WL_CONNECTED) {
-        if (millis() - startTime > WIFI_TIMEOUT_MS) {
-            logMessage("WiFi connection timed out");
-            return false;
+// Index into WIFI_NETWORKS of the strongest configured network in the
+// last scan, -1 if none is in sight
+int8_t bestScanned(int32_t& channel) {
+    int16_t found = WiFi.scanComplete();
+    int8_t best = -1;
+    int32_t bestRssi = INT32_MIN;
+    for (int16_t i = 0; i < found; i++) {
+        for (uint8_t n = 0; n < NETWORK_COUNT; n++) {
+            if (WiFi.SSID(i) == networks[n].ssid && WiFi.RSSI(i) > bestRssi) {
+                best = (int8_t)n;
+                bestRssi = WiFi.RSSI(i);
+                channel = WiFi.channel(i);
+            }
         }
-        delay(500);
-        Serial.print(".");
     }
-
-    Serial.println();
-    logMessage("WiFi connected to: " + WiFi.SSID() + " (" + WiFi.localIP().toString() + ")");
-    ledBlink(2);
-    return true;
+    WiFi.scanDelete();
+    return best;
 }
 
+// The likeliest networks on the channel they were last joined on, at the
+// TX power their history allows, then full scans at full power until
+// WIFI_TIMEOUT_MS. Each join ends on the driver's event or its timeout.
+class ConnectTask : public Task {
+public:
+    ConnectTask() : Task(PHASE_WIFI) {}
+
+    uint8_t attempts = 0;   // channel probes and full scans
+    int8_t  apIndex  = -1;  // into WIFI_NETWORKS, -1 if none
+
+    TaskState resume(uint32_t nowMs, EventBits_t events) override {
+        switch (step_) {
+        case START:
+            if (WiFi.status() == WL_CONNECTED) {
+                apIndex = joinedNetwork();
+                return finish(true);
+            }
+            LOG_DEBUG("Connecting to WiFi...");
+            WiFi.onEvent(onWiFiEvent);
+            // TX power can only be set once the driver is started
+            WiFi.mode(WIFI_STA);
+            probes_ = apProbeOrder(NETWORK_COUNT, order_, WIFI_PROBE_CANDIDATES);
+            return nextProbe(nowMs);
+
+        case PROBING:
+            if (events & WIFI_UP_BIT) return connected();
+            if (!(events & WIFI_DOWN_BIT) && !past(nowMs, joinUntilMs_)) break;
+            WiFi.disconnect();
+            apTxFailed(joining_);
+            return nextProbe(nowMs);
+
+        case SCANNING: {
+            if (!(events & WIFI_SCAN_BIT)) return TASK_RUNNING;
+            int32_t channel = 0;
+            int8_t index = bestScanned(channel);
+            uint32_t elapsed = nowMs - scanStartMs_;
+            if (elapsed >= WIFI_TIMEOUT_MS) return finish(false);
+            if (index < 0) return scan();
+            join((uint8_t)index, channel, nowMs, WIFI_TIMEOUT_MS - elapsed);
+            step_ = JOINING;
+            break;
+        }
+
+        case JOINING:
+            if (events & WIFI_UP_BIT) return connected();
+            if (!(events & WIFI_DOWN_BIT) && !past(nowMs, joinUntilMs_)) break;
+            WiFi.disconnect();
+            retried_ = true;
+            return scan();
+        }
+        resumeAtMs = joinUntilMs_;
+        return TASK_RUNNING;
+    }
+
+private:
+    enum Step : uint8_t { START, PROBING, SCANNING, JOINING };
+
+    static bool past(uint32_t nowMs, uint32_t atMs) { return (int32_t)(nowMs - atMs) >= 0; }
+
+    void join(uint8_t index, int32_t channel, uint32_t nowMs, uint32_t timeoutMs) {
+        joining_ = index;
+        joinUntilMs_ = nowMs + timeoutMs;
+        WiFi.begin(networks[index].ssid, networks[index].pass, channel);
+    }
+
+    TaskState nextProbe(uint32_t nowMs) {
+        if (probe_ == probes_) {
+            WiFi.setTxPower((wifi_power_t)AP_TX_POWER_MAX);
+            scanStartMs_ = nowMs;
+            return scan();
+        }
+        attempts++;
+        uint8_t index = order_[probe_++];
+        WiFi.setTxPower((wifi_power_t)apTxPower(index));
+        join(index, apRecord(index).channel, nowMs, WIFI_PROBE_TIMEOUT_MS);
+        step_ = PROBING;
+        resumeAtMs = joinUntilMs_;
+        return TASK_RUNNING;
+    }
+
+    // Scans don't time out; the result decides whether there is time left
+    TaskState scan() {
+        attempts++;
+        WiFi.scanNetworks(true);
+        step_ = SCANNING;
+        return TASK_RUNNING;
+    }
+
+    TaskState connected() {
+        apIndex = joinedNetwork();
+        if (apIndex >= 0) {
+            apJoined((uint8_t)apIndex, (uint8_t)WiFi.channel(), WiFi.RSSI());
+            if (retried_) apTxFailed((uint8_t)apIndex);
+        }
+        LOG_INFO("WiFi connected to: " + WiFi.SSID() + " (" + WiFi.localIP().toString() + ")");
+        ledBlink(2);
+        return finish(true);
+    }
+
+    TaskState finish(bool up) {
+        if (!up) LOG_WARN("WiFi connection timed out");
+        diagWifi(up ? WiFi.RSSI() : 0, attempts, apIndex, up ? (int8_t)WiFi.getTxPower() : 0);
+        return up ? TASK_DONE : TASK_FAILED;
+    }
+
+    Step     step_ = START;
+    uint8_t  order_[AP_HISTORY_MAX];
+    uint8_t  probes_      = 0;
+    uint8_t  probe_       = 0;      // next in order_
+    uint8_t  joining_     = 0;      // into WIFI_NETWORKS
+    uint32_t joinUntilMs_ = 0;
+    uint32_t scanStartMs_ = 0;
+    bool     retried_     = false;  // a join after a scan failed
+};
+
 // ============================================
 // NTP Time Sync
+// On the first wake and every NTP_SYNC_INTERVAL_BOOTS, once the link is
+// up; the budget, NTP_TIMEOUT_MS, is all it waits
 // ============================================
-void syncTime() {
-    configTime(0, 0, "pool.ntp.org", "time.nist.gov");
+void onTimeSync(struct timeval*) {
+    xEventGroupSetBits(wakeEvents, TIME_SET_BIT);
+}
 
-    struct tm timeinfo;
-    int retries = 0;
-    while (!getLocalTime(&timeinfo) && retries < 10) {
-        delay(500);
-        retries++;
+class SyncTask : public Task {
+public:
+    explicit SyncTask(const Task& link) : Task(PHASE_NTP, NTP_TIMEOUT_MS), link_(link) {}
+
+    TaskState resume(uint32_t, EventBits_t events) override {
+        if (!requested_) {
+            if (!link_.done()) return TASK_FAILED;
+            if (timeSynced && bootCount % NTP_SYNC_INTERVAL_BOOTS != 0) return TASK_DONE;
+            sntp_set_time_sync_notification_cb(onTimeSync);
+            configTime(0, 0, "pool.ntp.org", "time.nist.gov");
+            requested_ = true;
+        }
+        struct tm timeinfo;
+        if (!(events & TIME_SET_BIT) || !getLocalTime(&timeinfo, 0)) return TASK_RUNNING;
+        timeSynced = true;
+        LOG_INFO("Time synced: " + formatIsoTime(timeinfo));
+        return TASK_DONE;
     }
 
-    if (retries < 10) {
-        timeSynced = true;
-        char buf[20];
-        strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &timeinfo);
-        logMessage("Time synced: " + String(buf));
-    } else {
-        logMessage("NTP sync failed");
+    void cancel() override {
+        LOG_WARN("NTP sync failed");
     }
-}
+
+private:
+    const Task& link_;
+    bool        requested_ = false;
+};
 
 // ============================================
 // Get ISO 8601 timestamp
@@ -118,174 +294,357 @@ String getTimestamp() {
     if (!getLocalTime(&timeinfo)) {
         return "boot-" + String(bootCount);
     }
-    char buf[25];
-    strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &timeinfo);
-    return String(buf);
+    return formatIsoTime(timeinfo);
 }
 
-// ============================================
-// Temperature Sensor
-// ============================================
-float readTemperature() {
-    // Discard first read - DS18B20 returns 85°C (power-on default) on first conversion
-    sensors.requestTemperatures();
-    delay(800);
-    sensors.requestTemperatures();
-    float temp = sensors.getTempCByIndex(0);
-
-    if (temp == DEVICE_DISCONNECTED_C) {
-        logMessage("Sensor error: device disconnected");
-        return NAN;
-    }
+// Wall clock now, 0 before NTP. Zero timeout: the default waits 5 s for
+// a clock that isn't coming.
+time_t clockEpoch() {
+    struct tm timeinfo;
+    return getLocalTime(&timeinfo, 0) ? mktime(&timeinfo) : 0;
+}
 
-    if (temp < -55.0 || temp > 125.0) {
-        logMessage("Sensor error: reading out of range: " + String(temp));
-        return NAN;
-    }
+// The timestamp the reading would have had if stored when taken
+String heldTimestamp(const HeldReading& held) {
+    if (!held.epoch) return "boot-" + String(held.boot);
+    struct tm timeinfo;
+    localtime_r(&held.epoch, &timeinfo);
+    return formatIsoTime(timeinfo);
+}
+
+// "22.56" - for log lines
+String centiText(int32_t centi) {
+    char text[TEMP_TEXT_BYTES];
+    formatCenti(centi, text);
+    return String(text);
+}
 
-    return temp;
+// "22.56°C", or "22.56 / -- / 19.12°C" with more channels
+String recordText(const TempRecord& record) {
+    String text;
+    for (uint8_t ch = 0; ch < record.channels; ch++) {
+        if (ch > 0) text += " / ";
+        text += record.centiC[ch] == TEMP_INVALID ? String("--") : centiText(record.centiC[ch]);
+    }
+    return text + "°C";
 }
 
 // ============================================
 // Local CSV Storage
 // ============================================
-void storeReading(const String& timestamp, float tempC) {
-    bool fileExists = LittleFS.exists(DATA_FILE);
-
-    File file = LittleFS.open(DATA_FILE, FILE_APPEND);
-    if (!file) {
-        logMessage("Failed to open data file for writing");
-        return;
+// epoch: time for the index; "boot-N" rows have none (0)
+void storeReading(const String& timestamp, time_t epoch, const TempRecord& record) {
+    if (!appendReading(formatCsvRow(timestamp, record), epoch, formatCsvHeader(record.channels))) {
+        LOG_ERROR("Failed to open data file for writing");
     }
+}
 
-    if (!fileExists) {
-        file.println("timestamp,temperature_celsius");
-    }
+void storeReading(const String& timestamp, const TempRecord& record) {
+    storeReading(timestamp, timestamp.startsWith("boot-") ? 0 : clockEpoch(), record);
+}
 
-    file.println(timestamp + "," + String(tempC, 2));
-    file.close();
+// Rows for the readings held since the last full wake, oldest first
+void storeHeld() {
+    for (uint8_t i = 0; i < heldCount(); i++) {
+        const HeldReading& held = heldReading(i);
+        storeReading(heldTimestamp(held), held.epoch, held.record);
+    }
 }
 
 // ============================================
 // Send to Web Server
+// In two stages: openUpload() runs the DNS lookup and TLS handshake as
+// soon as the link is up, while the sensor converts, and sendToServer()
+// only sends over the open session.
 // ============================================
-bool sendToServer(float tempC, const String& timestamp) {
+WiFiClientSecure uploadClient;
+bool uploadRefused = false;   // openUpload() got no answer; don't wait again
+
+void openUpload(uint32_t timeoutMs) {
+    String url = SERVER_URL;
+    if (!url.startsWith("https://")) return;   // plain HTTP: HTTPClient connects itself
+    int hostAt = sizeof("https://") - 1;
+    int pathAt = url.indexOf('/', hostAt);
+    String host = url.substring(hostAt, pathAt < 0 ? url.length() : pathAt);
+    uint16_t port = 443;
+    int colon = host.indexOf(':');
+    if (colon >= 0) {
+        port = (uint16_t)host.substring(colon + 1).toInt();
+        host = host.substring(0, colon);
+    }
+    // As HTTPClient::begin(url) does without a CA certificate
+    uploadClient.setInsecure();
+    uploadRefused = !uploadClient.connect(host.c_str(), port, (int32_t)timeoutMs);
+}
+
+bool sendToServer(const TempRecord& record, const String& timestamp) {
     HTTPClient http;
-    http.begin(SERVER_URL);
+    if (uploadClient.connected()) {
+        http.setReuse(true);
+        http.begin(uploadClient, SERVER_URL);
+    } else {
+        http.begin(SERVER_URL);
+    }
     http.addHeader("Content-Type", "application/json");
     http.setTimeout(HTTP_TIMEOUT_MS);
 
-    JsonDocument doc;
-    doc["temperature"] = tempC;
-    doc["unit"]        = "celsius";
-    doc["timestamp"]   = timestamp;
-    doc["device"]      = DEVICE_NAME;
-
-    String payload;
-    serializeJson(doc, payload);
+    // Held readings first, oldest first, then this one, as a JSON array;
+    // a reading on its own goes as a bare object
+    uint8_t held = heldCount();
+    String payload = held ? "[" : "";
+    for (uint8_t i = 0; i < held; i++) {
+        payload += buildPayload(heldReading(i).record, heldTimestamp(heldReading(i)));
+        payload += ',';
+    }
+    payload += buildPayload(record, timestamp, diagForUpload());
+    if (held) payload += ']';
 
-    int responseCode = http.POST(payload);
+    int responseCode = uploadRefused ? HTTPC_ERROR_CONNECTION_REFUSED : http.POST(payload);
     http.end();
 
+    // Any answer below 500 means the server is up; a link lost on the way
+    // says nothing about it
+    BreakerState before = breakerState();
+    if (responseCode > 0 && responseCode < 500) breakerServerOk();
+    else if (WiFi.status() == WL_CONNECTED) breakerServerFailed();
+    if (breakerState() == BREAKER_OPEN) {
+        LOG_WARN("Server down: skipping the next " + String(breakerBackoff()) + " uploads");
+    } else if (before == BREAKER_HALF_OPEN && breakerState() == BREAKER_CLOSED) {
+        LOG_INFO("Server back: uploads resumed");
+    }
+
+    diagUploadResult(responseCode == 200);
     if (responseCode == 200) {
-        logMessage("Sent " + String(tempC, 2) + "°C (boot #" + String(bootCount) + ")");
+        LOG_INFO("Sent " + recordText(record) + (held ? " and " + String(held) + " held" : String("")) +
+                 " (boot #" + String(bootCount) + ")");
         return true;
     } else {
-        logMessage("Server error: " + String(responseCode));
+        for (uint8_t i = 0; i < held; i++) diagReadingUndelivered();
+        LOG_WARN("Server error: " + String(responseCode));
         return false;
     }
 }
 
+// A handshake can't be left halfway, so the budget is its timeout.
+// Nothing is opened while the circuit breaker is open.
+class OpenTask : public Task {
+public:
+    explicit OpenTask(const Task& link) : Task(PHASE_UPLOAD, HTTPCLIENT_DEFAULT_TCP_TIMEOUT), link_(link) {}
+
+    bool skipped = false;   // by the circuit breaker
+
+    TaskState resume(uint32_t nowMs, EventBits_t) override {
+        if (!link_.done()) return TASK_FAILED;
+        if (!breakerAllows()) {
+            skipped = true;
+            return TASK_FAILED;
+        }
+        openUpload(remainingMs(nowMs));
+        return TASK_DONE;
+    }
+
+private:
+    const Task& link_;
+};
+
+// ============================================
+// Wake cycle
+// The steps of a full wake as tasks on the executor (include/executor.h).
+// The sensor converts from the top of the wake; the rows are stored once
+// NTP has had its chance to set the clock, and sent once stored.
+// ============================================
+class SensorTask : public Task {
+public:
+    SensorTask() : Task(PHASE_SENSOR) {}
+
+    TempRecord record;
+
+    // The conversion is started before the executor runs
+    TaskState resume(uint32_t nowMs, EventBits_t) override {
+        if (!sensors.poll()) {
+            resumeAtMs = nowMs + SensorDriver::POLL_MS;
+            return TASK_RUNNING;
+        }
+        return sensors.read(record) ? TASK_DONE : TASK_FAILED;
+    }
+};
+
+class StoreTask : public Task {
+public:
+    StoreTask(const SensorTask& sensor, const Task& link) : Task(PHASE_STORE), sensor_(sensor), link_(link) {}
+
+    String timestamp;
+
+    TaskState resume(uint32_t, EventBits_t) override {
+        if (!sensor_.done()) return TASK_FAILED;
+        const TempRecord& record = sensor_.record;
+        timestamp = getTimestamp();
+
+        for (uint8_t ch = 0; ch < record.channels; ch++) {
+            int16_t centiC = record.centiC[ch];
+            if (centiC == TEMP_INVALID) continue;
+            SERIAL_PRINTLN("Temperature" + (SENSOR_CHANNELS > 1 ? " " + String(ch + 1) : String("")) + ": " +
+                centiText(centiC) + "°C / " + centiText(centiCToCentiF(centiC)) + "°F");
+        }
+
+        if (!link_.done()) {
+            LOG_WARN("No WiFi - storing reading locally only");
+            for (uint8_t i = 0; i <= heldCount(); i++) diagReadingUndelivered();
+        }
+        storeHeld();
+        storeReading(timestamp, record);
+        if (!link_.done()) {
+            clearHeld();
+            LOG_INFO("Stored locally: " + recordText(record));
+        }
+        return TASK_DONE;
+    }
+
+private:
+    const SensorTask& sensor_;
+    const Task&       link_;
+};
+
+class SendTask : public Task {
+public:
+    SendTask(const SensorTask& sensor, const StoreTask& store, const ConnectTask& link, const OpenTask& open)
+        : Task(PHASE_UPLOAD), sensor_(sensor), store_(store), link_(link), open_(open) {}
+
+    TaskState resume(uint32_t, EventBits_t) override {
+        if (!store_.done() || !link_.done()) return TASK_FAILED;
+        if (open_.skipped) {
+            // Stored, not sent, as without WiFi
+            for (uint8_t i = 0; i <= heldCount(); i++) diagReadingUndelivered();
+            clearHeld();
+            return TASK_FAILED;
+        }
+        bool sent = sendToServer(sensor_.record, store_.timestamp);
+        // Dropped off the AP mid-upload: the TX power may be too low
+        if (!sent && WiFi.status() != WL_CONNECTED && link_.apIndex >= 0) apTxFailed((uint8_t)link_.apIndex);
+        clearHeld();
+        return sent ? TASK_DONE : TASK_FAILED;
+    }
+
+private:
+    const SensorTask&  sensor_;
+    const StoreTask&   store_;
+    const ConnectTask& link_;
+    const OpenTask&    open_;
+};
+
 // ============================================
 // Go to deep sleep
 // ============================================
+void sleepNow() {
+    diagEndWake();
+    esp_sleep_enable_timer_wakeup((uint64_t)READING_INTERVAL_SEC * 1000000ULL);
+    esp_deep_sleep_start();
+}
+
 void goToSleep() {
-    logMessage("Sleeping for " + String(READING_INTERVAL_SEC) + "s...");
-    Serial.flush();
+    LOG_DEBUG("Sleeping for " + String(READING_INTERVAL_SEC) + "s...");
+    printFlashWear();
+    SERIAL_FLUSH();
 
     // Turn off WiFi and BT to save power
     WiFi.disconnect(true);
     WiFi.mode(WIFI_OFF);
 
-    esp_sleep_enable_timer_wakeup((uint64_t)READING_INTERVAL_SEC * 1000000ULL);
-    esp_deep_sleep_start();
+    sleepNow();
+}
+
+// ============================================
+// Sample-only wake - sensor to RTC memory and back to sleep. The radio
+// was never started and the filesystem is only mounted to log an error.
+// ============================================
+void sampleWake() {
+    diagPhase(PHASE_SENSOR);
+    TempRecord record;
+    if (sensors.begin() && sensors.read(record)) {
+        holdReading(clockEpoch(), bootCount, record);
+    } else {
+        LOG_ERROR(String("Sample wake: no reading from the ") + SensorDriver::name());
+        pinMode(LED_PIN, OUTPUT);
+        ledBlink(5, 50);
+    }
+    sleepNow();
 }
 
 // ============================================
 // Setup - runs on every wake from deep sleep
 // ============================================
 void setup() {
-    Serial.begin(115200);
-    delay(500);
+    diagBeginWake();
+    serialBegin();
 
     bootCount++;
+    storageBeginWake();
+    fsMounted = false;
+
+    WakeKind wake = classifyWake(bootCount, timeSynced);
+    if (wake == WAKE_SAMPLE) {
+        sampleWake();
+        return;
+    }
 
     pinMode(LED_PIN, OUTPUT);
     ledBlink(1, 200);
 
-    Serial.println("\n=============================");
-    Serial.println("  WiFi Thermometer - ESP32");
-    Serial.printf("  Wake #%d\n", bootCount);
-    Serial.println("=============================");
+    SERIAL_PRINTLN("\n=============================");
+    SERIAL_PRINTLN("  WiFi Thermometer - ESP32");
+    SERIAL_PRINTF("  Wake #%d (%s)\n", bootCount, wakeKindName(wake));
+    SERIAL_PRINTLN("=============================");
 
-    // Initialize LittleFS
-    if (!LittleFS.begin(true)) {
-        Serial.println("LittleFS mount failed");
-    }
+    mountFilesystem();
 
-    // Initialize sensor
-    sensors.begin();
-    if (sensors.getDeviceCount() == 0) {
-        logMessage("ERROR: No DS18B20 sensor found!");
-        ledBlink(5, 50);
-        goToSleep();
-        return;
+    // Any reset but a timer wake may have cut a write short
+    if (esp_reset_reason() != ESP_RST_DEEPSLEEP) {
+        size_t dropped = recoverReadings();
+        if (dropped) LOG_WARN("Recovery: cut " + String((int)dropped) + " torn bytes off the data file");
     }
 
-    // Register WiFi networks
-    struct { const char* ssid; const char* pass; } networks[] = WIFI_NETWORKS;
-    int networkCount = sizeof(networks) / sizeof(networks[0]);
-    for (int i = 0; i < networkCount; i++) {
-        wifiMulti.addAP(networks[i].ssid, networks[i].pass);
-    }
+    consoleRun(bootCount);
 
-    // Connect to WiFi
-    if (!connectWiFi()) {
-        logMessage("No WiFi - storing reading locally only");
-        float tempC = readTemperature();
-        if (!isnan(tempC)) {
-            storeReading(getTimestamp(), tempC);
-            logMessage("Stored locally: " + String(tempC, 2) + "°C");
-        }
-        ledBlink(3, 50);
+    // Initialize sensor
+    if (!sensors.begin()) {
+        LOG_ERROR(String("ERROR: No ") + SensorDriver::name() + " sensor found!");
+        ledBlink(5, 50);
         goToSleep();
         return;
     }
-
-    // Sync NTP on first boot or every N cycles
-    if (!timeSynced || bootCount % NTP_SYNC_INTERVAL_BOOTS == 0) {
-        syncTime();
-    }
-
-    // Read temperature
-    float tempC = readTemperature();
-
-    if (!isnan(tempC)) {
-        String timestamp = getTimestamp();
-
-        Serial.printf("Temperature: %.2f°C / %.2f°F\n",
-            tempC, (tempC * 9.0 / 5.0) + 32.0);
-
-        storeReading(timestamp, tempC);
-
-        if (sendToServer(tempC, timestamp)) {
-            ledBlink(1);
-        } else {
-            ledBlink(3, 50);
-        }
-    } else {
-        ledBlink(5, 50);
-    }
+    // Converts while the radio works
+    sensors.start();
+
+    if (!wakeEvents) wakeEvents = xEventGroupCreate();
+    xEventGroupClearBits(wakeEvents, EXECUTOR_EVENT_BITS);
+
+    ConnectTask connect;
+    SyncTask    sync(connect);
+    OpenTask    open(connect);
+    SensorTask  sensor;
+    StoreTask   store(sensor, connect);
+    SendTask    send(sensor, store, connect, open);
+    sync.runAfter(connect);
+    open.runAfter(connect);
+    store.runAfter(sensor);
+    store.runAfter(sync);       // after connect too, through sync
+    send.runAfter(open);
+    send.runAfter(store);
+
+    // Radio first: waiting time goes to the phase holding the wake up
+    Executor executor(wakeEvents);
+    executor.add(connect);
+    executor.add(sync);
+    executor.add(open);
+    executor.add(sensor);
+    executor.add(store);
+    executor.add(send);
+    executor.run();
+
+    if (!connect.done())     ledBlink(3, 50);
+    else if (!sensor.done()) ledBlink(5, 50);
+    else if (send.done())    ledBlink(1);
+    else                     ledBlink(3, 50);
 
     goToSleep();
 }
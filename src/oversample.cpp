@@ -0,0 +1,48 @@
+#include "oversample.h"
+
+static void sortSamples(int32_t* v, uint8_t n) {
+    for (uint8_t i = 1; i < n; i++) {
+        int32_t x = v[i];
+        uint8_t j = i;
+        for (; j > 0 && v[j - 1] > x; j--) v[j] = v[j - 1];
+        v[j] = x;
+    }
+}
+
+static int32_t distance(int32_t a, int32_t b) {
+    return a > b ? a - b : b - a;
+}
+
+bool filterSamples(int32_t* samples, uint8_t count, int32_t lsb, int32_t invalid,
+                   FilteredSamples& out) {
+    if (count > OVERSAMPLE_MAX) count = OVERSAMPLE_MAX;
+
+    uint8_t valid = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (samples[i] != invalid) samples[valid++] = samples[i];
+    }
+    out.sum = 0;
+    out.kept = 0;
+    out.rejected = count - valid;
+    out.mad = 0;
+    if (valid == 0 || valid * 2 < count) return false;
+
+    sortSamples(samples, valid);
+    int32_t median = samples[(valid - 1) / 2];
+
+    int32_t deviations[OVERSAMPLE_MAX];
+    for (uint8_t i = 0; i < valid; i++) deviations[i] = distance(samples[i], median);
+    sortSamples(deviations, valid);
+    out.mad = deviations[(valid - 1) / 2];
+
+    int32_t limit = out.mad * 3 > lsb ? out.mad * 3 : lsb;
+    for (uint8_t i = 0; i < valid; i++) {
+        if (distance(samples[i], median) <= limit) {
+            out.sum += samples[i];
+            out.kept++;
+        } else {
+            out.rejected++;
+        }
+    }
+    return true;
+}
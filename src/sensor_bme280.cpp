@@ -0,0 +1,79 @@
+#include "sensor_bme280.h"
+
+#include <Wire.h>
+#include "config.h"
+
+static const uint8_t REG_CALIB_T = 0x88;   // dig_T1..dig_T3, little-endian
+static const uint8_t REG_CHIP_ID = 0xD0;
+static const uint8_t REG_STATUS = 0xF3;    // bit 3: measuring
+static const uint8_t REG_CTRL_MEAS = 0xF4;
+static const uint8_t REG_TEMP = 0xFA;      // msb, lsb, xlsb
+static const uint8_t CHIP_ID = 0x60;
+static const uint8_t MODE_FORCED = 0x01;
+static const int32_t ADC_SKIPPED = 0x80000;
+
+bool Bme280::readRegisters(uint8_t reg, uint8_t* out, uint8_t len) {
+    Wire.beginTransmission(address_);
+    Wire.write(reg);
+    if (Wire.endTransmission(false) != 0) return false;
+    if (Wire.requestFrom(address_, len) != len) return false;
+    for (uint8_t i = 0; i < len; i++) out[i] = (uint8_t)Wire.read();
+    return true;
+}
+
+bool Bme280::begin(uint8_t address) {
+    address_ = address;
+    Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
+    uint8_t id;
+    uint8_t calib[6];
+    if (!readRegisters(REG_CHIP_ID, &id, 1) || id != CHIP_ID) return false;
+    if (!readRegisters(REG_CALIB_T, calib, sizeof(calib))) return false;
+    digT1_ = (uint16_t)(calib[1] << 8 | calib[0]);
+    digT2_ = (int16_t)(calib[3] << 8 | calib[2]);
+    digT3_ = (int16_t)(calib[5] << 8 | calib[4]);
+    return true;
+}
+
+// 12 bits = x2 oversampling (0.005 °C), less = x1 (0.01 °C, still below
+// one centi-degree step)
+void Bme280::configure(uint8_t bits) {
+    oversampling_ = bits >= 12 ? 2 : 1;
+}
+
+// Temperature only: pressure and humidity skipped, so a measurement is
+// 1.25 ms + 2.3 ms per temperature sample
+void Bme280::startConversion() {
+    Wire.beginTransmission(address_);
+    Wire.write(REG_CTRL_MEAS);
+    Wire.write((uint8_t)(oversampling_ << 5 | MODE_FORCED));
+    Wire.endTransmission();
+}
+
+uint32_t Bme280::readyMs() const {
+    return oversampling_ == 2 ? 6 : 4;
+}
+
+bool Bme280::conversionDone() {
+    uint8_t status;
+    return readRegisters(REG_STATUS, &status, 1) && !(status & 0x08);
+}
+
+bool Bme280::readRaw(int32_t& raw) {
+    uint8_t data[3];
+    if (!readRegisters(REG_TEMP, data, sizeof(data))) return false;
+    int32_t adc = (int32_t)data[0] << 12 | (int32_t)data[1] << 4 | data[2] >> 4;
+    if (adc == ADC_SKIPPED) return false;
+
+    // Datasheet 4.2.3, BME280_compensate_T_int32: 0.01 °C
+    int32_t var1 = ((((adc >> 3) - ((int32_t)digT1_ << 1))) * (int32_t)digT2_) >> 11;
+    int32_t delta = (adc >> 4) - (int32_t)digT1_;
+    int32_t var2 = (((delta * delta) >> 12) * (int32_t)digT3_) >> 14;
+    raw = ((var1 + var2) * 5 + 128) >> 8;
+    return true;
+}
+
+// Mean, rounded half away from zero
+int32_t Bme280::toCentiC(int32_t sum, uint32_t count) {
+    int32_t half = (int32_t)count / 2;
+    return (sum >= 0 ? sum + half : sum - half) / (int32_t)count;
+}
@@ -0,0 +1,33 @@
+#include "sensor_ds18b20.h"
+
+bool Ds18b20::begin(uint8_t pin) {
+    wire_.begin(pin);
+    sensor_.setOneWire(&wire_);
+    sensor_.begin();
+    // Conversions run while the CPU waits (or does something else)
+    sensor_.setWaitForConversion(false);
+    return sensor_.getDeviceCount() > 0 && sensor_.getAddress(address_, 0);
+}
+
+// Configuration register, scratchpad only: a power cycle brings back 12 bits
+void Ds18b20::configure(uint8_t bits) {
+    if (sensor_.setResolution(address_, bits)) bits_ = bits;
+}
+
+void Ds18b20::startConversion() {
+    sensor_.requestTemperatures();
+}
+
+uint32_t Ds18b20::readyMs() {
+    return sensor_.millisToWaitForConversion(bits_);
+}
+
+// One read slot: 0 while converting
+bool Ds18b20::conversionDone() {
+    return sensor_.isConversionComplete();
+}
+
+bool Ds18b20::readRaw(int32_t& raw) {
+    raw = sensor_.getTemp(address_);
+    return raw != DEVICE_DISCONNECTED_RAW;
+}
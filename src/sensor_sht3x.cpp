@@ -0,0 +1,83 @@
+#include "sensor_sht3x.h"
+
+#include <Wire.h>
+#include "config.h"
+
+// Single shot, no clock stretching: the second command byte and the
+// datasheet's maximum measurement time, per repeatability
+static const struct { uint8_t command; uint8_t ms; } MODES[] = {
+    { 0x00, 15 },   // high
+    { 0x0B, 6 },    // medium
+    { 0x16, 4 },    // low
+};
+
+// CRC-8, polynomial 0x31, init 0xFF, over each 16-bit word
+static uint8_t crc8(const uint8_t* data, size_t len) {
+    uint8_t crc = 0xFF;
+    while (len--) {
+        crc ^= *data++;
+        for (int bit = 0; bit < 8; bit++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+    }
+    return crc;
+}
+
+bool Sht3x::begin(uint8_t address) {
+    address_ = address;
+    Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN);
+    // Address only: a present sensor ACKs
+    Wire.beginTransmission(address_);
+    return Wire.endTransmission() == 0;
+}
+
+// Repeatability is per command, nothing to write: 12 bits = high,
+// 11 = medium, less = low
+void Sht3x::configure(uint8_t bits) {
+    repeatability_ = bits >= 12 ? 0 : bits == 11 ? 1 : 2;
+}
+
+void Sht3x::startConversion() {
+    done_ = false;
+    Wire.beginTransmission(address_);
+    Wire.write(0x24);
+    Wire.write(MODES[repeatability_].command);
+    Wire.endTransmission();
+}
+
+uint32_t Sht3x::readyMs() const {
+    return MODES[repeatability_].ms;
+}
+
+// A successful read takes the measurement off the sensor; keep it for
+// readRaw()
+bool Sht3x::conversionDone() {
+    if (!done_) {
+        uint8_t got = Wire.requestFrom(address_, (uint8_t)6);
+        if (got == 0) return false;
+        done_ = true;
+        valid_ = got == 6 && decode(raw_);
+    }
+    return true;
+}
+
+bool Sht3x::readRaw(int32_t& raw) {
+    if (!done_ && !conversionDone()) return false;
+    raw = raw_;
+    return valid_;
+}
+
+// Temperature word + CRC, humidity word + CRC, from the Wire buffer
+bool Sht3x::decode(int32_t& raw) {
+    uint8_t data[6];
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = (uint8_t)Wire.read();
+    if (crc8(data, 2) != data[2]) return false;
+    raw = (int32_t)data[0] << 8 | data[1];
+    return true;
+}
+
+// -45 °C + 175 °C * raw / 65535, rounded half away from zero
+int32_t Sht3x::toCentiC(int32_t sum, uint32_t count) {
+    int64_t scaled = (int64_t)sum * 17500;
+    int64_t divisor = (int64_t)65535 * count;
+    int64_t centi = (scaled >= 0 ? scaled + divisor / 2 : scaled - divisor / 2) / divisor;
+    return (int32_t)centi - 4500;
+}
@@ -0,0 +1,336 @@
+#include "storage.h"
+
+#include <LittleFS.h>
+#include <esp_partition.h>
+#include <unistd.h>
+#include "config.h"
+#include "console.h"
+
+const char* DATA_FILE = "/temperature_data.csv";
+const char* LOG_FILE  = "/thermometer.log";
+const char* INDEX_FILE = "/temperature_data.idx";
+
+// ============================================
+// Wear counters
+// The total lives in RTC memory, so it covers every wake since power-on.
+// ============================================
+static const uint32_t SECTOR_SIZE = 4096;
+
+static RTC_DATA_ATTR FlashWear wearTotal = { 0, 0, 0, 0 };
+static RTC_DATA_ATTR uint32_t  wearWakes = 0;
+static FlashWear wearWake;
+
+void storageBeginWake() {
+    memset(&wearWake, 0, sizeof(wearWake));
+    wearWakes++;
+}
+
+static bool isFilesystem(const esp_partition_t* partition) {
+    // Arduino partition tables label the LittleFS partition as spiffs
+    return partition->type == ESP_PARTITION_TYPE_DATA &&
+           (partition->subtype == ESP_PARTITION_SUBTYPE_DATA_SPIFFS || partition->subtype == 0x83);
+}
+
+// ============================================
+// Block device hooks - every flash write and erase goes through these
+// ============================================
+extern "C" esp_err_t __real_esp_partition_write(const esp_partition_t* partition, size_t dst_offset,
+                                                const void* src, size_t size);
+extern "C" esp_err_t __real_esp_partition_erase_range(const esp_partition_t* partition, size_t offset,
+                                                      size_t size);
+
+extern "C" esp_err_t __wrap_esp_partition_write(const esp_partition_t* partition, size_t dst_offset,
+                                                const void* src, size_t size) {
+    if (isFilesystem(partition)) {
+        wearWake.programBytes += size;
+        wearTotal.programBytes += size;
+    }
+    return __real_esp_partition_write(partition, dst_offset, src, size);
+}
+
+extern "C" esp_err_t __wrap_esp_partition_erase_range(const esp_partition_t* partition, size_t offset,
+                                                      size_t size) {
+    uint32_t sectors = (size + SECTOR_SIZE - 1) / SECTOR_SIZE;
+    if (isFilesystem(partition)) {
+        wearWake.eraseSectors += sectors;
+        wearTotal.eraseSectors += sectors;
+    } else {
+        wearWake.otherEraseSectors += sectors;
+        wearTotal.otherEraseSectors += sectors;
+    }
+    return __real_esp_partition_erase_range(partition, offset, size);
+}
+
+// ============================================
+// Files
+// ============================================
+static void countLogical(size_t bytes) {
+    wearWake.logicalBytes += bytes;
+    wearTotal.logicalBytes += bytes;
+}
+
+bool appendToFile(const char* path, const String& text) {
+    File file = LittleFS.open(path, FILE_APPEND);
+    if (!file) return false;
+
+    size_t written = file.print(text);
+    file.close();
+
+    countLogical(written);
+    return true;
+}
+
+// ============================================
+// Time index
+// INDEX_FILE holds one entry per DATA_INDEX_STRIDE bytes of DATA_FILE:
+// the time and offset of the first timed row starting in that stretch.
+// Entries are appended after the rows they point at are committed, so a
+// power cut can only lose an entry, never leave one pointing past the data.
+// ============================================
+struct IndexEntry {
+    uint32_t epoch;
+    uint32_t offset;
+};
+
+// Offset at which the next entry is due. Cached in RTC memory so a timer
+// wake doesn't have to open the index to find out; reloaded after a reset.
+static RTC_DATA_ATTR bool     indexLoaded = false;
+static RTC_DATA_ATTR uint32_t indexNextOffset = 0;
+
+static uint32_t strideAfter(uint32_t offset) {
+    return (offset / DATA_INDEX_STRIDE + 1) * DATA_INDEX_STRIDE;
+}
+
+static void loadIndexState() {
+    indexNextOffset = 0;
+    File index = LittleFS.open(INDEX_FILE, FILE_READ);
+    if (index) {
+        IndexEntry last;
+        size_t entries = index.size() / sizeof(IndexEntry);
+        if (entries > 0 && index.seek((entries - 1) * sizeof(IndexEntry)) &&
+            index.read((uint8_t*)&last, sizeof(last)) == sizeof(last)) {
+            indexNextOffset = strideAfter(last.offset);
+        }
+        index.close();
+    }
+    indexLoaded = true;
+}
+
+static void indexRow(time_t epoch, uint32_t offset) {
+    if (!indexLoaded) loadIndexState();
+    if (epoch <= 0 || offset < indexNextOffset) return;
+
+    File index = LittleFS.open(INDEX_FILE, FILE_APPEND);
+    if (!index) return;
+    IndexEntry entry = { (uint32_t)epoch, offset };
+    size_t written = index.write((const uint8_t*)&entry, sizeof(entry));
+    index.close();
+
+    countLogical(written);
+    if (written == sizeof(entry)) indexNextOffset = strideAfter(offset);
+}
+
+// ============================================
+// Records
+// A row of DATA_FILE is "<row>,<crc>\r\n": the CRC-16 of the row text in
+// four hex digits, then the line ending, written last, as commit marker.
+// A row without both is a torn write and recovery cuts it off.
+// ============================================
+// CRC-16/CCITT-FALSE
+static uint16_t crc16(const char* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    while (len--) {
+        crc ^= (uint16_t)((uint8_t)*data++ << 8);
+        for (int bit = 0; bit < 8; bit++) crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+// A complete line without its line ending. Files from before the CRC
+// column have rows with a single comma, which are taken as they are.
+static bool validRecord(const char* line, size_t len) {
+    if (len >= 10 && strncmp(line, "timestamp,", 10) == 0) return true;
+    const char* first = (const char*)memchr(line, ',', len);
+    if (!first) return false;
+    size_t crcAt = len;                         // just past the last comma
+    while (line[crcAt - 1] != ',') crcAt--;
+    if (line + crcAt - 1 == first) return true; // no CRC column
+    if (len - crcAt != 4) return false;
+
+    char hex[5];
+    snprintf(hex, sizeof(hex), "%04x", crc16(line, crcAt - 1));
+    return strncmp(line + crcAt, hex, 4) == 0;
+}
+
+bool appendReading(const String& row, time_t epoch, const String& header) {
+    File file = LittleFS.open(DATA_FILE, FILE_APPEND);
+    if (!file) return false;
+
+    size_t offset = file.size();
+    size_t written = 0;
+    if (offset == 0) {
+        // New data file: an index left from an earlier one no longer applies
+        if (LittleFS.exists(INDEX_FILE)) LittleFS.remove(INDEX_FILE);
+        indexLoaded = true;
+        indexNextOffset = 0;
+        written = file.print(header + ",crc16\r\n");
+    }
+    char crc[8];
+    snprintf(crc, sizeof(crc), ",%04x\r\n", crc16(row.c_str(), row.length()));
+    uint32_t rowOffset = offset + written;
+    written += file.print(row);
+    written += file.print(crc);
+    file.close();
+
+    countLogical(written);
+    indexRow(epoch, rowOffset);
+    return true;
+}
+
+size_t readingsOffsetFor(time_t since) {
+    File index = LittleFS.open(INDEX_FILE, FILE_READ);
+    if (!index) return 0;
+
+    // Last entry timed before 'since': rows from there on may qualify
+    size_t lo = 0;
+    size_t hi = index.size() / sizeof(IndexEntry);
+    uint32_t offset = 0;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        IndexEntry entry;
+        if (!index.seek(mid * sizeof(IndexEntry)) ||
+            index.read((uint8_t*)&entry, sizeof(entry)) != sizeof(entry)) {
+            break;
+        }
+        if ((time_t)entry.epoch < since) {
+            offset = entry.offset;
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    index.close();
+
+    // Stale index (data file replaced or cut short): read from the start
+    File data = LittleFS.open(DATA_FILE, FILE_READ);
+    size_t size = data ? data.size() : 0;
+    if (data) data.close();
+    return offset < size ? offset : 0;
+}
+
+// ============================================
+// Recovery
+// Only the tail can be torn - rows are appended and never rewritten - so
+// the scan covers the last DATA_RECOVERY_WINDOW bytes whatever the size
+// of the file, and cuts the file after the last valid row in it.
+// ============================================
+// littlefs is mounted under this VFS path; the FS API has no truncate
+static const char* VFS_BASE = "/littlefs";
+
+static bool truncateFile(const char* path, size_t size) {
+    char full[48];
+    snprintf(full, sizeof(full), "%s%s", VFS_BASE, path);
+    return truncate(full, (off_t)size) == 0;
+}
+
+// Index entries past the end of the data go, and so does a torn entry
+static void recoverIndex(size_t dataSize) {
+    File index = LittleFS.open(INDEX_FILE, FILE_READ);
+    if (!index) return;
+    size_t size = index.size();
+    size_t keep = size - size % sizeof(IndexEntry);
+    IndexEntry entry;
+    while (keep > 0 && index.seek(keep - sizeof(entry)) &&
+           index.read((uint8_t*)&entry, sizeof(entry)) == sizeof(entry) && entry.offset >= dataSize) {
+        keep -= sizeof(entry);
+    }
+    index.close();
+    if (keep < size) truncateFile(INDEX_FILE, keep);
+    indexLoaded = false;
+}
+
+size_t recoverReadings() {
+    File file = LittleFS.open(DATA_FILE, FILE_READ);
+    if (!file) return 0;
+
+    size_t size = file.size();
+    size_t start = size > DATA_RECOVERY_WINDOW ? size - DATA_RECOVERY_WINDOW : 0;
+    file.seek(start);
+
+    // Walk the window line by line; the first partial line is skipped
+    // unless the window starts at the top of the file
+    char line[96];
+    size_t len = 0;
+    bool whole = start == 0;
+    bool overflow = false;
+    size_t pos = start;
+    size_t keep = start == 0 ? 0 : SIZE_MAX;
+    uint8_t block[128];
+    size_t n;
+    while ((n = file.read(block, sizeof(block))) > 0) {
+        for (size_t i = 0; i < n; i++) {
+            char c = (char)block[i];
+            pos++;
+            if (c != '\n') {
+                if (len < sizeof(line)) line[len++] = c;
+                else overflow = true;
+                continue;
+            }
+            if (len > 0 && line[len - 1] == '\r') len--;
+            if (whole && !overflow && validRecord(line, len)) keep = pos;
+            whole = true;
+            overflow = false;
+            len = 0;
+        }
+    }
+    file.close();
+
+    // Nothing valid in a whole window is not a torn tail; leave it be
+    if (keep == SIZE_MAX || keep >= size) {
+        // The cut may have come after the row, in its index entry
+        recoverIndex(size);
+        return 0;
+    }
+    if (!truncateFile(DATA_FILE, keep)) return 0;
+    recoverIndex(keep);
+    return size - keep;
+}
+
+bool removeReadings() {
+    indexLoaded = true;
+    indexNextOffset = 0;
+    bool removed = !LittleFS.exists(DATA_FILE) || LittleFS.remove(DATA_FILE);
+    if (LittleFS.exists(INDEX_FILE)) LittleFS.remove(INDEX_FILE);
+    return removed;
+}
+
+const FlashWear& flashWearThisWake()     { return wearWake; }
+const FlashWear& flashWearSincePowerOn() { return wearTotal; }
+
+// ============================================
+// Diagnostics
+// ============================================
+float flashLifetimeYears() {
+    size_t sectors = LittleFS.totalBytes() / SECTOR_SIZE;
+    if (wearWakes == 0 || wearTotal.eraseSectors == 0 || sectors == 0) return 0;
+
+    float erasesPerWake = (float)wearTotal.eraseSectors / wearWakes;
+    float wakesPerDay = 86400.0f / READING_INTERVAL_SEC;
+    float days = (float)sectors * FLASH_ENDURANCE_CYCLES / (erasesPerWake * wakesPerDay);
+    return days / 365.0f;
+}
+
+void printFlashWear() {
+#if SERIAL_OUTPUT
+    if (!serialUp()) return;
+    const FlashWear& w = wearWake;
+    SERIAL_PRINTF("Flash: %u B stored, %u B programmed (%.1fx), %u sector erases (+%u other)",
+        (unsigned)w.logicalBytes, (unsigned)w.programBytes,
+        w.logicalBytes ? (float)w.programBytes / w.logicalBytes : 0.0f,
+        (unsigned)w.eraseSectors, (unsigned)w.otherEraseSectors);
+
+    float years = flashLifetimeYears();
+    if (years > 0) SERIAL_PRINTF("; wear-out in %.1f years\n", years);
+    else           SERIAL_PRINTLN();
+#endif
+}
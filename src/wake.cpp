@@ -0,0 +1,47 @@
+#include "wake.h"
+
+#include "config.h"
+#include "console.h"
+
+static_assert(UPLOAD_EVERY_N_READINGS >= 1 && UPLOAD_EVERY_N_READINGS <= 32,
+              "UPLOAD_EVERY_N_READINGS out of range");
+
+// The Nth reading is taken on the upload wake itself, never held
+static const uint8_t HELD_MAX = UPLOAD_EVERY_N_READINGS > 1 ? UPLOAD_EVERY_N_READINGS - 1 : 1;
+
+static RTC_DATA_ATTR HeldReading held[HELD_MAX];
+static RTC_DATA_ATTR uint8_t     heldReadings = 0;
+
+WakeKind classifyWake(int bootCount, bool timeSynced) {
+    if (esp_reset_reason() != ESP_RST_DEEPSLEEP || serialUp()) return WAKE_MAINTENANCE;
+    if (!timeSynced || bootCount % NTP_SYNC_INTERVAL_BOOTS == 0) return WAKE_SYNC;
+    if (heldReadings + 1 >= UPLOAD_EVERY_N_READINGS) return WAKE_UPLOAD;
+    return WAKE_SAMPLE;
+}
+
+const char* wakeKindName(WakeKind kind) {
+    switch (kind) {
+        case WAKE_SAMPLE:      return "sample";
+        case WAKE_UPLOAD:      return "upload";
+        case WAKE_SYNC:        return "sync";
+        case WAKE_MAINTENANCE: return "maintenance";
+    }
+    return "?";
+}
+
+void holdReading(time_t epoch, int32_t boot, const TempRecord& record) {
+    // Full only if every wake since the last flush was sample-only, which
+    // classifyWake() doesn't allow; drop the oldest rather than the newest
+    if (heldReadings == HELD_MAX) {
+        memmove(&held[0], &held[1], sizeof(held[0]) * (HELD_MAX - 1));
+        heldReadings--;
+    }
+    held[heldReadings].epoch = epoch;
+    held[heldReadings].boot = boot;
+    held[heldReadings].record = record;
+    heldReadings++;
+}
+
+uint8_t            heldCount()                   { return heldReadings; }
+const HeldReading& heldReading(uint8_t index)    { return held[index]; }
+void               clearHeld()                   { heldReadings = 0; }